@@ -1,11 +1,38 @@
 #ifndef MICROBUF_MICROBUF_H
 #define MICROBUF_MICROBUF_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <limits.h>
+#include <string.h>
+
+// CRC-32C uses the SSE4.2 crc32 instruction (if the CPU has it, checked at runtime) or the ARMv8 CRC extension
+// (if enabled for the compiler, e.g. -march=armv8-a+crc) - define MICROBUF_NO_HW_CRC32C to always use software
+#if !defined(MICROBUF_NO_HW_CRC32C) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MICROBUF_CRC32C_X86
+#include <nmmintrin.h>
+#elif !defined(MICROBUF_NO_HW_CRC32C) && defined(__ARM_FEATURE_CRC32)
+#define MICROBUF_CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
+// On AVR (e.g. Arduino Uno), constant tables are kept in flash instead of the small SRAM
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define MICROBUF_PROGMEM PROGMEM
+#else
+#define MICROBUF_PROGMEM
+#endif
 
 namespace microbuf {
 
+    // Checksum appended to a message
+    enum class checksum_type : uint8_t {
+        none,
+        crc16,  // CRC16/AUG-CCITT as msgpack uint16 (3 bytes)
+        crc32c  // CRC-32C (Castagnoli) as msgpack uint32 (5 bytes)
+    };
+
     template <class T, size_t N>
     struct array {
         // Statically-sized array - basically like std::array, but does not need the STL
@@ -48,6 +75,15 @@ namespace microbuf {
         memcpy(dest.begin()+index, source.begin(), source_length);
     }
 
+    // insert all bytes in source into dest at index (for fields without a static offset) - returns index behind them
+    // The caller has to make sure that dest is large enough (e.g. data_size of a message)
+    template<size_t dest_length, size_t source_length>
+    size_t insert_bytes(array<uint8_t,dest_length>& dest, const size_t index, const array<uint8_t,source_length>& source)
+    {
+        memcpy(dest.begin()+index, source.begin(), source_length);
+        return index+source_length;
+    }
+
     namespace internal {
         template <typename T>
         union bytes_union {
@@ -109,28 +145,38 @@ namespace microbuf {
             return bytes;
         }
 
-        // Convert serialized msgpack data to primitive type
-        // Start reading at index in bytes
-        template<size_t index,typename T,size_t N>
-        inline bool from_msgpack_data(const array<uint8_t,N>& bytes, const uint8_t prefix, T& result) {
-            static_assert(index+1+sizeof(T) <= N, "bytes is too small to contain a prefix and T at index");
-
-            if(bytes[index] != prefix) {
-                return false;
-            }
-
+        // Convert Big Endian representation (without msgpack prefix) to primitive type
+        template<typename T>
+        inline T from_big_endian(const uint8_t* bytes) {
             bytes_union<T> val_union {};
 
             // Save from Big Endian input
             val_union.bytes = 0;
             for(size_t i=0; i<(sizeof(T)); ++i) {
-                val_union.bytes |= static_cast<typename bytes_union<T>::uint_type>(bytes[index+1+i]) << 8U*(sizeof(T)-1-i);
+                val_union.bytes |= static_cast<typename bytes_union<T>::uint_type>(bytes[i]) << 8U*(sizeof(T)-1-i);
             }
-            result = val_union.val;
+            return val_union.val;
+        }
+
+        // Convert serialized msgpack data to primitive type
+        // Start reading at index in length bytes
+        template<size_t index,typename T>
+        inline bool from_msgpack_data(const uint8_t* bytes, const size_t length, const uint8_t prefix, T& result) {
+            if(index+1+sizeof(T) > length || bytes[index] != prefix) {
+                return false;
+            }
+
+            result = from_big_endian<T>(bytes+index+1);
 
             return true;
         }
 
+        template<size_t index,typename T,size_t N>
+        inline bool from_msgpack_data(const array<uint8_t,N>& bytes, const uint8_t prefix, T& result) {
+            static_assert(index+1+sizeof(T) <= N, "bytes is too small to contain a prefix and T at index");
+            return from_msgpack_data<index>(bytes.begin(), N, prefix, result);
+        }
+
         // TODO: unused - remove?
         // Get an array of the data in bytes from index_start to index_end (NOT including it)
         template<size_t index_start, size_t index_end, size_t N>
@@ -144,38 +190,156 @@ namespace microbuf {
             return result;
         }
 
-        inline uint16_t crc16_aug_ccitt(const uint8_t *ptr, uint32_t count) {
-            // Return CRC16/AUG-CCITT (https://reveng.sourceforge.io/crc-catalogue/16.htm)
-            // width=16 poly=0x1021 init=0x1d0f refin=false refout=false xorout=0x0000
-            // check=0xe5cc residue=0x0000 name="CRC-16/SPI-FUJITSU"
-            //
-            // Compare http://srecord.sourceforge.net/crc16-ccitt.html and
-            // https://hg.ulukai.org/ecm/crc16-t/file/f5262db9f5e0/test2.c#l40
-            uint16_t crc;
-            uint8_t i, v, ch;
-            crc = 0xFFFF;
+        // CRC16/AUG-CCITT (https://reveng.sourceforge.io/crc-catalogue/16.htm)
+        // width=16 poly=0x1021 init=0x1d0f refin=false refout=false xorout=0x0000
+        // check=0xe5cc residue=0x0000 name="CRC-16/SPI-FUJITSU"
+        //
+        // Compare http://srecord.sourceforge.net/crc16-ccitt.html - the augmented algorithm with init 0xffff
+        // is equivalent to this direct algorithm with init 0x1d0f, which can be updated byte by byte
+        static const uint16_t crc16_init = 0x1d0fU;
+
+        // Add one byte to crc
+        inline uint16_t crc16_update(uint16_t crc, const uint8_t byte) {
+            crc ^= static_cast<uint16_t>(byte << 8U);
+            for(uint8_t i=0; i<8; ++i) {
+                if (crc & 0x8000U)
+                    crc = static_cast<uint16_t>(crc << 1U) ^ 0x1021U;
+                else
+                    crc = static_cast<uint16_t>(crc << 1U);
+            }
+            return crc;
+        }
+
+        // Add count bytes to crc
+        inline uint16_t crc16_update(uint16_t crc, const uint8_t *ptr, size_t count) {
             while (count) {
-                ch = *ptr++;
-                i = 8;
-                v = 0x80;
-                do {
-                    if (crc & 0x8000U)
-                        crc = static_cast<uint16_t>(crc << 1U) ^ 0x1021U;
-                    else
-                        crc = (crc << 1U);
-                    if (ch & v)
-                        crc ^= 1U;
-                    v >>= 1U;
-                } while (--i);
+                crc = crc16_update(crc, *ptr++);
                 --count;
             }
-            for (i = 0; i < 16; ++i) {
-                if (crc & 0x8000U)
-                    crc = static_cast<uint16_t>(crc << 1U) ^ 0x1021U;
+            return crc;
+        }
+
+        // CRC-32C: poly=0x1edc6f41 (reflected 0x82f63b78) init=0xffffffff refin=true refout=true xorout=0xffffffff
+        // check=0xe3069283 - the update functions work on the register before the final xorout
+        static const uint32_t crc32c_init = 0xffffffffUL;
+
+        // Table for crc32c_update_sw(): CRC-32C of the 4 bit values (64 bytes - in flash on AVR)
+        static const uint32_t crc32c_table[16] MICROBUF_PROGMEM {
+                0x00000000UL, 0x105ec76fUL, 0x20bd8edeUL, 0x30e349b1UL, 0x417b1dbcUL, 0x5125dad3UL, 0x61c69362UL,
+                0x7198540dUL, 0x82f63b78UL, 0x92a8fc17UL, 0xa24bb5a6UL, 0xb21572c9UL, 0xc38d26c4UL, 0xd3d3e1abUL,
+                0xe330a81aUL, 0xf36e6f75UL};
+
+        inline uint32_t crc32c_table_entry(const uint32_t index) {
+#if defined(__AVR__)
+            return pgm_read_dword(&crc32c_table[index]);
+#else
+            return crc32c_table[index];
+#endif
+        }
+
+        // Add count bytes to crc in software with a table for 4 bits (e.g. for Arduino)
+        inline uint32_t crc32c_update_sw(uint32_t crc, const uint8_t *ptr, size_t count) {
+            while (count) {
+                crc ^= *ptr++;
+                crc = (crc >> 4U) ^ crc32c_table_entry(crc & 0x0fU);
+                crc = (crc >> 4U) ^ crc32c_table_entry(crc & 0x0fU);
+                --count;
+            }
+            return crc;
+        }
+
+#if defined(MICROBUF_CRC32C_X86)
+        // Add count bytes to crc with the SSE4.2 crc32 instruction - only call if crc32c_hw_available()
+        __attribute__((target("sse4.2")))
+        inline uint32_t crc32c_update_hw(uint32_t crc, const uint8_t *ptr, size_t count) {
+#if defined(__x86_64__)
+            for (; count >= sizeof(uint64_t); count -= sizeof(uint64_t), ptr += sizeof(uint64_t)) {
+                uint64_t value;
+                memcpy(&value, ptr, sizeof(value));
+                crc = static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+            }
+#endif
+            for (; count > 0; --count) {
+                crc = _mm_crc32_u8(crc, *ptr++);
+            }
+            return crc;
+        }
+
+        inline bool crc32c_hw_available() {
+            static const bool available = []() {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse4.2") != 0;
+            }();
+            return available;
+        }
+#elif defined(MICROBUF_CRC32C_ARM)
+        // Add count bytes to crc with the ARMv8 CRC extension
+        inline uint32_t crc32c_update_hw(uint32_t crc, const uint8_t *ptr, size_t count) {
+#if !defined(__ARM_BIG_ENDIAN)
+            for (; count >= sizeof(uint64_t); count -= sizeof(uint64_t), ptr += sizeof(uint64_t)) {
+                uint64_t value;
+                memcpy(&value, ptr, sizeof(value));
+                crc = __crc32cd(crc, value);
+            }
+#endif
+            for (; count > 0; --count) {
+                crc = __crc32cb(crc, *ptr++);
+            }
+            return crc;
+        }
+
+        inline bool crc32c_hw_available() { return true; }
+#endif
+
+        // Add count bytes to crc - in hardware if possible
+        inline uint32_t crc32c_update(const uint32_t crc, const uint8_t *ptr, const size_t count) {
+#if defined(MICROBUF_CRC32C_X86) || defined(MICROBUF_CRC32C_ARM)
+            if (crc32c_hw_available()) {
+                return crc32c_update_hw(crc, ptr, count);
+            }
+#endif
+            return crc32c_update_sw(crc, ptr, count);
+        }
+
+        inline uint32_t crc32c(const uint8_t *ptr, const size_t count) {
+            return ~crc32c_update(crc32c_init, ptr, count);
+        }
+
+        // Multiply two polynomials modulo the CRC16 polynomial (0x1021 with implicit x^16)
+        inline uint16_t crc16_mulmod(const uint16_t a, const uint16_t b) {
+            uint16_t result = 0;
+            for(uint8_t i=16; i>0; --i) {
+                if (result & 0x8000U)
+                    result = static_cast<uint16_t>(result << 1U) ^ 0x1021U;
                 else
-                    crc = (crc << 1U);
+                    result = static_cast<uint16_t>(result << 1U);
+                if (b & (1U << (i-1U)))
+                    result ^= a;
             }
-            return (crc);
+            return result;
+        }
+
+        // CRC after adding count zero bytes to crc (i.e. crc * x^(8*count)) without touching each byte
+        // Combines partial CRCs: crc(A followed by B) = crc16_shift(crc(A), |B|) ^ crc of B starting at 0
+        inline uint16_t crc16_shift(const uint16_t crc, size_t count) {
+            uint16_t factor = 1;
+            uint16_t power = 0x0100U; // x^8, squared for each bit of count
+            while (count) {
+                if (count & 1U)
+                    factor = crc16_mulmod(factor, power);
+                power = crc16_mulmod(power, power);
+                count >>= 1U;
+            }
+            return crc16_mulmod(crc, factor);
+        }
+
+        inline uint16_t crc16_aug_ccitt(const uint8_t *ptr, uint32_t count) {
+            uint16_t crc = crc16_init;
+            while (count) {
+                crc = crc16_update(crc, *ptr++);
+                --count;
+            }
+            return crc;
         }
 
         // TODO: unused - remove?
@@ -192,10 +356,12 @@ namespace microbuf {
             return result;
         }
 
-        // Check if bytes1 at index1 contains bytes2
-        template<size_t index1, size_t N1, size_t N2>
-        inline bool bytes_equal(const array<uint8_t,N1>& bytes1, const array<uint8_t,N2> bytes2) {
-            static_assert(index1+N2 <= N1, "bytes2 does not fit into bytes1 when starting at index1");
+        // Check if bytes1 (with length1 bytes) at index1 contains bytes2
+        template<size_t index1, size_t N2>
+        inline bool bytes_equal(const uint8_t* bytes1, const size_t length1, const array<uint8_t,N2>& bytes2) {
+            if(index1+N2 > length1) {
+                return false;
+            }
             for(size_t i=0; i<bytes2.size(); ++i) {
                 if(bytes1[index1+i] != bytes2[i]) {
                     return false;
@@ -204,6 +370,13 @@ namespace microbuf {
             return true;
         }
 
+        // Check if bytes1 at index1 contains bytes2
+        template<size_t index1, size_t N1, size_t N2>
+        inline bool bytes_equal(const array<uint8_t,N1>& bytes1, const array<uint8_t,N2> bytes2) {
+            static_assert(index1+N2 <= N1, "bytes2 does not fit into bytes1 when starting at index1");
+            return bytes_equal<index1>(bytes1.begin(), N1, bytes2);
+        }
+
         // Needed data for parse_multiple
         template<typename T>
         struct ParsingInfo{};
@@ -216,33 +389,54 @@ namespace microbuf {
         template<>
         struct ParsingInfo<uint8_t>{
             static const size_t num_bytes_serialized = 2;
+            static const uint8_t prefix = 0xcc;
         };
 
         template<>
         struct ParsingInfo<uint16_t>{
             static const size_t num_bytes_serialized = 3;
+            static const uint8_t prefix = 0xcd;
         };
 
         template<>
         struct ParsingInfo<uint32_t>{
             static const size_t num_bytes_serialized = 5;
+            static const uint8_t prefix = 0xce;
         };
 
         template<>
         struct ParsingInfo<uint64_t>{
             static const size_t num_bytes_serialized = 9;
+            static const uint8_t prefix = 0xcf;
         };
 
         template<>
         struct ParsingInfo<float>{
             static const size_t num_bytes_serialized = 5;
+            static const uint8_t prefix = 0xca;
         };
 
         template<> // might not be used if doubles are not 64 bits
         struct ParsingInfo<double>{
             static const size_t num_bytes_serialized = 9;
+            static const uint8_t prefix = 0xcb;
         };
 
+        // Parse a plain field (prefix and value) which starts at bytes - the caller has to check the length
+        template<typename T>
+        inline bool parse_plain(const uint8_t* bytes, T& result) {
+            if(bytes[0] != ParsingInfo<T>::prefix) {
+                return false;
+            }
+            result = from_big_endian<T>(bytes+1);
+            return true;
+        }
+
+        inline bool parse_plain(const uint8_t* bytes, bool& result) {
+            result = bytes[0] == 0xc3;
+            return result || bytes[0] == 0xc2;
+        }
+
         // Generate multiple plain microbuf fields after each other from an array
         // MultipleGeneratorClass is needed b/c function templates cannot be partially specialized but classes can
         template<size_t num_elements, size_t each_length, typename T>
@@ -288,6 +482,33 @@ namespace microbuf {
         return internal::MultipleGeneratorClass<num_elements,each_length,T>::gen_multiple(source_array, gen_element);
     }
 
+    // Generate the plain microbuf fields of source[begin] to source[end-1] and write them to dest at index
+    // This will not put a msgpack array marker in the beginning
+    // Unlike gen_multiple, this is a loop and therefore also works for arrays with millions of elements
+    template<size_t index, size_t num_elements, size_t each_length, typename T, size_t N>
+    inline void insert_multiple(array<uint8_t,N>& dest, const T (&source)[num_elements],
+                                array<uint8_t,each_length> (*gen_element)(T),
+                                const size_t begin = 0, const size_t end = num_elements) {
+        static_assert(index+num_elements*each_length <= N, "Destination too small");
+        for(size_t i=begin; i<end; ++i) {
+            const array<uint8_t,each_length> element = gen_element(source[i]);
+            memcpy(dest.begin()+index+i*each_length, element.begin(), each_length);
+        }
+    }
+
+    // Generate the plain microbuf fields of source and write them to dest at index (for fields without a static
+    // offset) - returns index behind them
+    // The caller has to make sure that dest is large enough (e.g. data_size of a message)
+    template<size_t num_elements, size_t each_length, typename T, size_t N>
+    inline size_t insert_multiple(array<uint8_t,N>& dest, const size_t index, const T (&source)[num_elements],
+                                  array<uint8_t,each_length> (*gen_element)(T)) {
+        for(size_t i=0; i<num_elements; ++i) {
+            const array<uint8_t,each_length> element = gen_element(source[i]);
+            memcpy(dest.begin()+index+i*each_length, element.begin(), each_length);
+        }
+        return index+num_elements*each_length;
+    }
+
     // Parse multiple plain microbuf fields from source_arr at index to dest
     // WARNING: This will not check dest's size!
     template<size_t num_elements, size_t index, typename T, size_t N>
@@ -321,6 +542,54 @@ namespace microbuf {
         return parse_multiple_unsafe<num_elements, index>(source_arr, dest, parse_element);
     }
 
+    // Parse multiple plain microbuf fields at index of length bytes to dest, check dest size
+    // Each element is parsed in place (e.g. with parse_float32<0>) - only dest[begin] to dest[end-1] if given
+    template<size_t num_elements, size_t index, typename T>
+    inline bool parse_multiple(const uint8_t* bytes, const size_t length, T (&dest)[num_elements],
+                               bool (*parse_element)(const uint8_t*, size_t, T&),
+                               const size_t begin = 0, const size_t end = num_elements) {
+        constexpr size_t num_bytes_serialized = internal::ParsingInfo<T>::num_bytes_serialized;
+        if(index+num_elements*num_bytes_serialized > length) {
+            return false;
+        }
+
+        for(size_t i=begin; i<end; ++i) {
+            if(!parse_element(bytes+index+i*num_bytes_serialized, num_bytes_serialized, dest[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Parse plain microbuf field at index of length bytes (for fields without a static offset)
+    // On success, index is moved behind the field
+    template<typename T>
+    inline bool parse_plain_at(const uint8_t* bytes, const size_t length, size_t& index, T& result) {
+        constexpr size_t num_bytes_serialized = internal::ParsingInfo<T>::num_bytes_serialized;
+        if(index+num_bytes_serialized > length || !internal::parse_plain(bytes+index, result)) {
+            return false;
+        }
+        index += num_bytes_serialized;
+        return true;
+    }
+
+    // Parse multiple plain microbuf fields at index of length bytes to dest (for fields without a static offset)
+    // On success, index is moved behind the fields
+    template<size_t num_elements, typename T>
+    inline bool parse_multiple_at(const uint8_t* bytes, const size_t length, size_t& index, T (&dest)[num_elements]) {
+        constexpr size_t num_bytes_serialized = internal::ParsingInfo<T>::num_bytes_serialized;
+        if(index+num_elements*num_bytes_serialized > length) {
+            return false;
+        }
+        for(size_t i=0; i<num_elements; ++i) {
+            if(!internal::parse_plain(bytes+index+i*num_bytes_serialized, dest[i])) {
+                return false;
+            }
+        }
+        index += num_elements*num_bytes_serialized;
+        return true;
+    }
+
     // TODO: also implement parse_multiple and gen_multiple as safe methods for microbuf::array
 
     // Generate fixarray
@@ -351,6 +620,13 @@ namespace microbuf {
         return to_msgpack_data(f, 0xca);
     }
 
+    template<size_t index>
+    inline bool parse_float32(const uint8_t* bytes, const size_t length, float& result) {
+        using namespace internal;
+        static_assert(sizeof(float) * CHAR_BIT == 32, "System must have 32-bit floats");
+        return from_msgpack_data<index>(bytes, length, 0xca, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_float32(const array<uint8_t,N>& bytes, float& result) {
         using namespace internal;
@@ -367,6 +643,13 @@ namespace microbuf {
         return to_msgpack_data(d, 0xcb);
     }
 
+    template<size_t index>
+    inline bool parse_float64(const uint8_t* bytes, const size_t length, double& result) {
+        using namespace internal;
+        static_assert(sizeof(double) * CHAR_BIT == 64, "System must have 64-bit doubles");
+        return from_msgpack_data<index>(bytes, length, 0xcb, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_float64(const array<uint8_t,N>& bytes, double& result) {
         using namespace internal;
@@ -402,51 +685,95 @@ namespace microbuf {
         }
     }
 
+    template<size_t index>
+    inline bool check_fixarray(const uint8_t* bytes, const size_t bytes_length, const uint8_t length) {
+        using namespace internal;
+        return bytes_equal<index>(bytes, bytes_length, gen_fixarray(length));
+    }
+
     template<size_t index,size_t N>
     inline bool check_fixarray(const array<uint8_t,N>& bytes, const uint8_t length) {
         using namespace internal;
         return bytes_equal<index>(bytes, gen_fixarray(length));
     }
 
+    template<size_t index>
+    inline bool check_array16(const uint8_t* bytes, const size_t bytes_length, const uint16_t length) {
+        using namespace internal;
+        return bytes_equal<index>(bytes, bytes_length, gen_array16(length));
+    }
+
     template<size_t index,size_t N>
     inline bool check_array16(const array<uint8_t,N>& bytes, const uint16_t length) {
         using namespace internal;
         return bytes_equal<index>(bytes, gen_array16(length));
     }
 
+    template<size_t index>
+    inline bool check_array32(const uint8_t* bytes, const size_t bytes_length, const uint32_t length) {
+        using namespace internal;
+        return bytes_equal<index>(bytes, bytes_length, gen_array32(length));
+    }
+
     template<size_t index,size_t N>
     inline bool check_array32(const array<uint8_t,N>& bytes, const uint32_t length) {
         using namespace internal;
         return bytes_equal<index>(bytes, gen_array32(length));
     }
 
+    template<size_t index>
+    inline bool parse_uint8(const uint8_t* bytes, const size_t length, uint8_t& result) {
+        using namespace internal;
+        return from_msgpack_data<index>(bytes, length, 0xcc, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_uint8(const array<uint8_t,N>& bytes, uint8_t& result) {
         using namespace internal;
         return from_msgpack_data<index>(bytes, 0xcc, result);
     }
 
+    template<size_t index>
+    inline bool parse_uint16(const uint8_t* bytes, const size_t length, uint16_t& result) {
+        using namespace internal;
+        return from_msgpack_data<index>(bytes, length, 0xcd, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_uint16(const array<uint8_t,N>& bytes, uint16_t& result) {
         using namespace internal;
         return from_msgpack_data<index>(bytes, 0xcd, result);
     }
 
+    template<size_t index>
+    inline bool parse_uint32(const uint8_t* bytes, const size_t length, uint32_t& result) {
+        using namespace internal;
+        return from_msgpack_data<index>(bytes, length, 0xce, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_uint32(const array<uint8_t,N>& bytes, uint32_t& result) {
         using namespace internal;
         return from_msgpack_data<index>(bytes, 0xce, result);
     }
 
+    template<size_t index>
+    inline bool parse_uint64(const uint8_t* bytes, const size_t length, uint64_t& result) {
+        using namespace internal;
+        return from_msgpack_data<index>(bytes, length, 0xcf, result);
+    }
+
     template<size_t index,size_t N>
     inline bool parse_uint64(const array<uint8_t,N>& bytes, uint64_t& result) {
         using namespace internal;
         return from_msgpack_data<index>(bytes, 0xcf, result);
     }
 
-    template<size_t index,size_t N>
-    inline bool parse_bool(const array<uint8_t,N>& bytes, bool& result) {
-        static_assert(index < N, "Array index out of bounds");
+    template<size_t index>
+    inline bool parse_bool(const uint8_t* bytes, const size_t length, bool& result) {
+        if(index >= length) {
+            return false;
+        }
         if(bytes[index] == 0xc3) {
             result = true;
             return true;
@@ -458,6 +785,12 @@ namespace microbuf {
         }
     }
 
+    template<size_t index,size_t N>
+    inline bool parse_bool(const array<uint8_t,N>& bytes, bool& result) {
+        static_assert(index < N, "Array index out of bounds");
+        return parse_bool<index>(bytes.begin(), N, result);
+    }
+
     // Add CRC16 checksum to the end of bytes
     // Will ignore the last three bytes for CRC calculation and put the uint16 CRC there
     template<size_t N>
@@ -469,20 +802,646 @@ namespace microbuf {
         insert_bytes<N-3>(bytes, gen_uint16(crc));
     }
 
+    // Check CRC16 checksum at the end of length bytes
+    inline bool verify_crc(const uint8_t* bytes, const size_t length) {
+        using namespace internal;
+        if(length < 3 || bytes[length-3] != 0xcd) {
+            return false;
+        }
+        return crc16_aug_ccitt(bytes, length-3) == from_big_endian<uint16_t>(bytes+length-2);
+    }
+
     // Check CRC16 checksum at the end of bytes
     // Will ignore the last three bytes for CRC calculation
     template<size_t N>
     inline bool verify_crc(const array<uint8_t,N>& bytes) {
         using namespace internal;
         static_assert(N>=3, "bytes must at least have space for checksum (3 bytes)");
+        return verify_crc(bytes.begin(), N);
+    }
+
+    // Add CRC-32C checksum to the end of bytes
+    // Will ignore the last five bytes for CRC calculation and put the uint32 CRC there
+    template<size_t N>
+    inline void append_crc32c(array<uint8_t,N>& bytes) {
+        static_assert(N>=5, "bytes must at least have space for checksum (5 bytes)");
+        insert_bytes<N-5>(bytes, gen_uint32(internal::crc32c(&bytes[0], N-5)));
+    }
+
+    // Add CRC-32C checksum after the first length bytes (for messages with variable size)
+    // Returns the new length - bytes must have space for 5 more bytes
+    template<size_t N>
+    inline size_t append_crc32c(array<uint8_t,N>& bytes, const size_t length) {
+        return insert_bytes(bytes, length, gen_uint32(internal::crc32c(&bytes[0], length)));
+    }
+
+    // Check CRC-32C checksum at the end of length bytes
+    inline bool verify_crc32c(const uint8_t* bytes, const size_t length) {
+        using namespace internal;
+        if(length < 5 || bytes[length-5] != 0xce) {
+            return false;
+        }
+        return crc32c(bytes, length-5) == from_big_endian<uint32_t>(bytes+length-4);
+    }
+
+    // Check CRC-32C checksum at the end of bytes
+    // Will ignore the last five bytes for CRC calculation
+    template<size_t N>
+    inline bool verify_crc32c(const array<uint8_t,N>& bytes) {
+        static_assert(N>=5, "bytes must at least have space for checksum (5 bytes)");
+        return verify_crc32c(bytes.begin(), N);
+    }
+
+    // Extract the plain field at offset from num_frames serialized messages which are stored back to back in frames
+    // (stride bytes each, e.g. data_size) and write it to column. Only the bytes of this field are read from each
+    // frame - unless check_crc is set, which needs the complete frame.
+    // Returns the number of valid frames. For an invalid frame (wrong prefix or CRC) the column value is set to T{}
+    // and, if valid is not nullptr, valid[i] to false. checksum is the type of CRC which check_crc verifies.
+    template<size_t offset, size_t stride, typename T, checksum_type checksum = checksum_type::crc16>
+    inline size_t extract_column(const uint8_t* frames, const size_t num_frames, T* column,
+                                 const bool check_crc = false, bool* valid = nullptr) {
+        using namespace internal;
+        static_assert(offset+ParsingInfo<T>::num_bytes_serialized <= stride, "Field does not fit into a frame");
+
+        size_t num_valid = 0;
+        const uint8_t* frame = frames;
+        for(size_t i=0; i<num_frames; ++i, frame += stride) {
+            T value {};
+            bool worked = parse_plain(frame+offset, value);
+            if(check_crc) {
+                worked = worked && (checksum == checksum_type::crc32c ? verify_crc32c(frame, stride)
+                                                                      : verify_crc(frame, stride));
+            }
+            column[i] = worked ? value : T{};
+            if(valid != nullptr) {
+                valid[i] = worked;
+            }
+            num_valid += worked ? 1 : 0;
+        }
+        return num_valid;
+    }
+
+    // Add CRC16 checksum after the first length bytes (for messages with variable size)
+    // Returns the new length - bytes must have space for 3 more bytes
+    template<size_t N>
+    inline size_t append_crc(array<uint8_t,N>& bytes, const size_t length) {
+        using namespace internal;
+        const array<uint8_t,3> crc_bytes = gen_uint16(crc16_aug_ccitt(&bytes[0], length));
+        memcpy(bytes.begin()+length, crc_bytes.begin(), crc_bytes.size());
+        return length+crc_bytes.size();
+    }
+
+
+    // Parallel serialization and deserialization of large messages (opt-in with "parallel: yes" in the .mmsg file)
+    // Large array fields and the CRC are split into chunks of at least parallel_chunk_size bytes which are run by an
+    // Executor - any class with
+    //     template<typename F> bool parallel_for(size_t num_tasks, F f)
+    // which calls f(task) for each task < num_tasks (in any order and thread), waits for all of them and returns
+    // whether all calls returned true. See microbuf_parallel.h for a thread pool.
+    // The bytes are the same as for the serial functions.
+
+    static const size_t parallel_chunk_size = 16384;
+    static const size_t parallel_max_chunks = 64;
+
+    // Executor which runs all tasks in the calling thread
+    struct serial_executor {
+        template<typename F>
+        bool parallel_for(const size_t num_tasks, F f) {
+            bool worked = true;
+            for(size_t task=0; task<num_tasks; ++task) {
+                worked = f(task) && worked;
+            }
+            return worked;
+        }
+    };
+
+    namespace internal {
+        inline size_t num_parallel_chunks(const size_t num_bytes) {
+            const size_t num_chunks = (num_bytes + parallel_chunk_size - 1) / parallel_chunk_size;
+            return num_chunks < 1 ? 1 : (num_chunks > parallel_max_chunks ? parallel_max_chunks : num_chunks);
+        }
+
+        // First element of chunk if num_elements are split into num_chunks chunks (the end is the next chunk's begin)
+        inline size_t parallel_chunk_begin(const size_t num_elements, const size_t num_chunks, const size_t chunk) {
+            const size_t remainder = num_elements % num_chunks; // the first chunks get one more element
+            return num_elements / num_chunks * chunk + (chunk < remainder ? chunk : remainder);
+        }
+    } // namespace microbuf::internal
+
+    // Like insert_multiple, but split into chunks which are run by executor
+    template<size_t index, size_t num_elements, size_t each_length, typename T, size_t N, class Executor>
+    inline void insert_multiple_parallel(array<uint8_t,N>& dest, const T (&source)[num_elements],
+                                         array<uint8_t,each_length> (*gen_element)(T), Executor& executor) {
+        const size_t num_chunks = internal::num_parallel_chunks(num_elements*each_length);
+        executor.parallel_for(num_chunks, [&](const size_t chunk) {
+            insert_multiple<index>(dest, source, gen_element,
+                                   internal::parallel_chunk_begin(num_elements, num_chunks, chunk),
+                                   internal::parallel_chunk_begin(num_elements, num_chunks, chunk+1));
+            return true;
+        });
+    }
+
+    // Like parse_multiple, but split into chunks which are run by executor
+    template<size_t num_elements, size_t index, typename T, class Executor>
+    inline bool parse_multiple_parallel(const uint8_t* bytes, const size_t length, T (&dest)[num_elements],
+                                        bool (*parse_element)(const uint8_t*, size_t, T&), Executor& executor) {
+        constexpr size_t num_bytes_serialized = internal::ParsingInfo<T>::num_bytes_serialized;
+        const size_t num_chunks = internal::num_parallel_chunks(num_elements*num_bytes_serialized);
+        return executor.parallel_for(num_chunks, [&](const size_t chunk) {
+            return parse_multiple<num_elements,index>(bytes, length, dest, parse_element,
+                                                      internal::parallel_chunk_begin(num_elements, num_chunks, chunk),
+                                                      internal::parallel_chunk_begin(num_elements, num_chunks, chunk+1));
+        });
+    }
+
+    namespace internal {
+        // CRC16 of count bytes from partial CRCs of chunks which are run by executor
+        template<class Executor>
+        inline uint16_t crc16_aug_ccitt_parallel(const uint8_t *ptr, const size_t count, Executor& executor) {
+            const size_t num_chunks = num_parallel_chunks(count);
+            uint16_t partial_crcs[parallel_max_chunks];
+            executor.parallel_for(num_chunks, [&](const size_t chunk) {
+                const size_t begin = parallel_chunk_begin(count, num_chunks, chunk);
+                partial_crcs[chunk] = crc16_update(0, ptr+begin, parallel_chunk_begin(count, num_chunks, chunk+1)-begin);
+                return true;
+            });
+
+            uint16_t crc = crc16_init;
+            for(size_t chunk=0; chunk<num_chunks; ++chunk) {
+                const size_t chunk_length = parallel_chunk_begin(count, num_chunks, chunk+1) -
+                                            parallel_chunk_begin(count, num_chunks, chunk);
+                crc = crc16_shift(crc, chunk_length) ^ partial_crcs[chunk];
+            }
+            return crc;
+        }
+    } // namespace microbuf::internal
+
+    // Like append_crc, but the CRC is calculated by executor
+    template<size_t N, class Executor>
+    inline void append_crc_parallel(array<uint8_t,N>& bytes, Executor& executor) {
+        static_assert(N>=3, "bytes must at least have space for checksum (3 bytes)");
+        insert_bytes<N-3>(bytes, gen_uint16(internal::crc16_aug_ccitt_parallel(&bytes[0], N-3, executor)));
+    }
+
+    // Like verify_crc, but the CRC is calculated by executor
+    template<class Executor>
+    inline bool verify_crc_parallel(const uint8_t* bytes, const size_t length, Executor& executor) {
+        using namespace internal;
+        if(length < 3 || bytes[length-3] != 0xcd) {
+            return false;
+        }
+        return crc16_aug_ccitt_parallel(bytes, length-3, executor) == from_big_endian<uint16_t>(bytes+length-2);
+    }
+
+
+    // Push parser: decode a message byte by byte as the bytes arrive (e.g. from I2C or a serial port)
+    // The generated push_byte() of a message struct calls the push_* function of the field at the current position.
+    // Each field is written to the struct as soon as its last byte arrived, so no buffer for the message is needed.
+
+    enum class push_result : uint8_t {
+        in_progress, // byte accepted, message not complete yet
+        done,        // last byte accepted and message valid (incl. CRC)
+        failed       // invalid byte - the struct may contain some new fields, reset() the state to start over
+    };
+
+    struct push_state {
+        size_t index {0};                     // position of the next byte in the message
+        uint16_t crc {internal::crc16_init};  // CRC of all bytes before index
+        uint64_t value {0};                   // Big Endian value of the current field so far
+
+        void reset() { *this = push_state {}; }
+    };
+
+    namespace internal {
+        inline void push_accept(push_state& state, const uint8_t byte) {
+            state.crc = crc16_update(state.crc, byte);
+            ++state.index;
+        }
+
+        // Push byte of the plain field which starts at index
+        template<typename T>
+        inline bool push_plain(push_state& state, const uint8_t byte, const size_t index, T& result) {
+            const size_t position = state.index-index; // 0: prefix
+            if(position == 0) {
+                if(byte != ParsingInfo<T>::prefix) {
+                    return false;
+                }
+                state.value = 0;
+            } else {
+                state.value = state.value << 8U | byte;
+            }
+            push_accept(state, byte);
+
+            if(position == sizeof(T)) {
+                bytes_union<T> val_union {};
+                val_union.bytes = static_cast<typename bytes_union<T>::uint_type>(state.value);
+                result = val_union.val;
+            }
+            return true;
+        }
+
+        inline bool push_plain(push_state& state, const uint8_t byte, const size_t, bool& result) {
+            if(byte != 0xc3 && byte != 0xc2) {
+                return false;
+            }
+            result = byte == 0xc3;
+            push_accept(state, byte);
+            return true;
+        }
+    }
+
+    // Push byte of the msgpack array header at index (see gen_fixarray etc.)
+    template<size_t index, size_t N>
+    inline bool push_header(push_state& state, const uint8_t byte, const array<uint8_t,N>& header) {
+        if(byte != header[state.index-index]) {
+            return false;
+        }
+        internal::push_accept(state, byte);
+        return true;
+    }
+
+    // Push byte of the plain field at index
+    template<size_t index, typename T>
+    inline bool push_plain(push_state& state, const uint8_t byte, T& result) {
+        return internal::push_plain(state, byte, index, result);
+    }
+
+    // Push byte of the plain array field at index
+    template<size_t index, size_t num_elements, typename T>
+    inline bool push_multiple(push_state& state, const uint8_t byte, T (&dest)[num_elements]) {
+        constexpr size_t num_bytes_serialized = internal::ParsingInfo<T>::num_bytes_serialized;
+        const size_t element = (state.index-index) / num_bytes_serialized;
+        return internal::push_plain(state, byte, index+element*num_bytes_serialized, dest[element]);
+    }
+
+    // Push byte of the CRC16 at index, which must be compared to the CRC of all bytes before
+    template<size_t index>
+    inline bool push_crc(push_state& state, const uint8_t byte) {
+        const size_t position = state.index-index; // 0: prefix
+        const uint8_t expected = position == 0 ? 0xcd : static_cast<uint8_t>(state.crc >> 8U*(2-position));
+        if(byte != expected) {
+            return false;
+        }
+        ++state.index; // the CRC does not cover itself
+        return true;
+    }
+
+    // Result of pushing a byte to a message with length bytes
+    inline push_result push_verdict(const push_state& state, const bool worked, const size_t length) {
+        if(!worked) {
+            return push_result::failed;
+        }
+        return state.index == length ? push_result::done : push_result::in_progress;
+    }
+
+    namespace internal {
+        inline uint8_t count_leading_zeros32(const uint32_t value) {
+            // value must not be 0
+            #if defined __GNUC__
+            return static_cast<uint8_t>(__builtin_clzl(value) - (sizeof(unsigned long)*CHAR_BIT - 32));
+            #else
+            uint8_t num = 0;
+            while((value & (0x80000000UL >> num)) == 0) { ++num; }
+            return num;
+            #endif
+        }
+
+        inline uint8_t count_trailing_zeros32(const uint32_t value) {
+            // value must not be 0
+            #if defined __GNUC__
+            return static_cast<uint8_t>(__builtin_ctzl(value));
+            #else
+            uint8_t num = 0;
+            while((value & (1UL << num)) == 0) { ++num; }
+            return num;
+            #endif
+        }
+
+        // Write bits MSB first - stops writing (but keeps counting) when capacity is exceeded
+        struct bit_writer {
+            uint8_t* dest;
+            size_t capacity;
+            size_t length;
+            uint64_t buffer;
+            uint8_t num_buffered;
+
+            // Append the lowest num_bits (<= 32) of value
+            void put(const uint32_t value, const uint8_t num_bits) {
+                buffer = (buffer << num_bits) | (value & ((static_cast<uint64_t>(1) << num_bits) - 1));
+                num_buffered = static_cast<uint8_t>(num_buffered + num_bits);
+                while(num_buffered >= 8) {
+                    num_buffered = static_cast<uint8_t>(num_buffered - 8);
+                    if(length < capacity) {
+                        dest[length] = static_cast<uint8_t>(buffer >> num_buffered);
+                    }
+                    ++length;
+                }
+            }
+
+            // Pad last byte with zeros - returns number of bytes
+            size_t finish() {
+                if(num_buffered > 0) {
+                    put(0, static_cast<uint8_t>(8 - num_buffered));
+                }
+                return length;
+            }
+        };
+
+        // Read bits MSB first
+        struct bit_reader {
+            const uint8_t* src;
+            size_t length;
+            size_t position;
+            uint64_t buffer;
+            uint8_t num_buffered;
+
+            // Read num_bits (<= 32) to value
+            bool get(const uint8_t num_bits, uint32_t& value) {
+                while(num_buffered < num_bits) {
+                    if(position >= length) {
+                        return false;
+                    }
+                    buffer = (buffer << 8U) | src[position++];
+                    num_buffered = static_cast<uint8_t>(num_buffered + 8);
+                }
+                num_buffered = static_cast<uint8_t>(num_buffered - num_bits);
+                value = static_cast<uint32_t>((buffer >> num_buffered) & ((static_cast<uint64_t>(1) << num_bits) - 1));
+                return true;
+            }
+        };
+
+        // Encode num_values floats with Gorilla-style XOR coding
+        // dest needs 1+4*num_values bytes. If XOR coding would not save space, the raw values are stored.
+        // Returns the number of bytes written.
+        //
+        // Layout: mode byte (0: raw Big Endian values, 1: XOR-coded), then for mode 1 a bit stream (MSB first):
+        // first value (32 bits), then for each following value XORed with its predecessor:
+        //   '0'                                       - equal to predecessor
+        //   '10' + meaningful bits                    - meaningful bits fit into the previous window
+        //   '11' + 5 bits leading zeros + 5 bits (number of meaningful bits - 1) + meaningful bits
+        inline size_t encode_xor_delta(const float* values, const size_t num_values, uint8_t* dest) {
+            static_assert(sizeof(float) * CHAR_BIT == 32, "System must have 32-bit floats");
+            const size_t raw_length = 1 + 4*num_values;
+
+            bit_writer writer {dest+1, raw_length-1, 0, 0, 0};
+            bytes_union<float> val_union {};
+            val_union.val = values[0];
+            uint32_t previous = val_union.bytes;
+            writer.put(previous, 32);
+
+            uint8_t window_leading = 0;
+            uint8_t window_length = 0; // 0: no window yet
+            for(size_t i=1; i<num_values && writer.length <= writer.capacity; ++i) {
+                val_union.val = values[i];
+                const uint32_t x = val_union.bytes ^ previous;
+                previous = val_union.bytes;
+                if(x == 0) {
+                    writer.put(0, 1);
+                    continue;
+                }
+                const uint8_t leading = count_leading_zeros32(x);
+                const uint8_t trailing = count_trailing_zeros32(x);
+                if(window_length > 0 && leading >= window_leading && 32-trailing <= window_leading+window_length) {
+                    writer.put(0x2, 2);
+                    writer.put(x >> (32-window_leading-window_length), window_length);
+                } else {
+                    window_leading = leading;
+                    window_length = static_cast<uint8_t>(32-leading-trailing);
+                    writer.put(0x3, 2);
+                    writer.put(window_leading, 5);
+                    writer.put(window_length-1U, 5);
+                    writer.put(x >> trailing, window_length);
+                }
+            }
+
+            const size_t num_bytes = writer.finish();
+            if(num_bytes <= writer.capacity) {
+                dest[0] = 1;
+                return 1+num_bytes;
+            }
+
+            // XOR coding does not help - store raw values
+            dest[0] = 0;
+            for(size_t i=0; i<num_values; ++i) {
+                val_union.val = values[i];
+                for(size_t j=0; j<4; ++j) {
+                    dest[1+4*i+j] = static_cast<uint8_t>(val_union.bytes >> 8U*(3-j));
+                }
+            }
+            return raw_length;
+        }
+
+        // Decode num_values floats which were encoded with encode_xor_delta from exactly length bytes
+        inline bool decode_xor_delta(const uint8_t* src, const size_t length, float* values, const size_t num_values) {
+            if(length < 1) {
+                return false;
+            }
+            if(src[0] == 0) {
+                if(length != 1 + 4*num_values) {
+                    return false;
+                }
+                for(size_t i=0; i<num_values; ++i) {
+                    values[i] = from_big_endian<float>(src+1+4*i);
+                }
+                return true;
+            }
+            if(src[0] != 1) {
+                return false;
+            }
+
+            bit_reader reader {src+1, length-1, 0, 0, 0};
+            bytes_union<float> val_union {};
+            if(!reader.get(32, val_union.bytes)) {
+                return false;
+            }
+            values[0] = val_union.val;
+
+            uint32_t window_leading = 0;
+            uint32_t window_length = 0; // 0: no window yet
+            for(size_t i=1; i<num_values; ++i) {
+                uint32_t control {};
+                if(!reader.get(1, control)) {
+                    return false;
+                }
+                if(control == 1) {
+                    if(!reader.get(1, control)) {
+                        return false;
+                    }
+                    if(control == 1) {
+                        if(!reader.get(5, window_leading) || !reader.get(5, window_length)) {
+                            return false;
+                        }
+                        ++window_length;
+                        if(window_leading+window_length > 32) {
+                            return false;
+                        }
+                    } else if(window_length == 0) {
+                        return false;
+                    }
+                    uint32_t meaningful {};
+                    if(!reader.get(static_cast<uint8_t>(window_length), meaningful)) {
+                        return false;
+                    }
+                    val_union.bytes ^= meaningful << (32-window_leading-window_length);
+                }
+                values[i] = val_union.val;
+            }
+
+            // all bytes must have been used (only padding bits may be left)
+            return reader.position == reader.length && reader.num_buffered < 8;
+        }
+
+        // Size information for fields with xor_delta encoding (stored as msgpack bin)
+        template<size_t num_values>
+        struct XorDeltaInfo {
+            static_assert(num_values > 0, "At least one value is needed");
+            static const uint32_t max_payload_length = 1 + 4*num_values;
+            static const uint8_t bin_prefix = max_payload_length <= 0xffU ? 0xc4 : (max_payload_length <= 0xffffU ? 0xc5 : 0xc6);
+            static const size_t header_length = max_payload_length <= 0xffU ? 2 : (max_payload_length <= 0xffffU ? 3 : 5);
+            static const size_t max_num_bytes_serialized = header_length + max_payload_length;
+        };
+    } // namespace microbuf::internal
 
-        const uint16_t expected_crc = internal::crc16_aug_ccitt(&bytes[0], N-3);
-        uint16_t crc{};
-        if(!parse_uint16<N-3>(bytes, crc)) {
+    // Generate msgpack bin with xor_delta-encoded values at index - returns the index after it
+    // WARNING: bytes must have space for internal::XorDeltaInfo<num_values>::max_num_bytes_serialized bytes at index
+    template<size_t num_values, size_t N>
+    inline size_t gen_xor_delta(array<uint8_t,N>& bytes, const size_t index, const float (&values)[num_values]) {
+        using namespace internal;
+        using info = XorDeltaInfo<num_values>;
+        static_assert(info::max_num_bytes_serialized <= N, "bytes is too small");
+
+        const uint32_t payload_length = static_cast<uint32_t>(
+                encode_xor_delta(values, num_values, bytes.begin()+index+info::header_length));
+        bytes[index] = info::bin_prefix;
+        for(size_t i=1; i<info::header_length; ++i) {
+            bytes[index+i] = static_cast<uint8_t>(payload_length >> 8U*(info::header_length-1-i));
+        }
+        return index+info::header_length+payload_length;
+    }
+
+    // Parse msgpack bin with xor_delta-encoded values at index from the first length bytes
+    // On success, index is moved behind the bin
+    template<size_t num_values>
+    inline bool parse_xor_delta(const uint8_t* bytes, const size_t length, size_t& index,
+                                float (&values)[num_values]) {
+        using namespace internal;
+        using info = XorDeltaInfo<num_values>;
+        if(index+info::header_length > length || bytes[index] != info::bin_prefix) {
+            return false;
+        }
+        uint32_t payload_length = 0;
+        for(size_t i=1; i<info::header_length; ++i) {
+            payload_length = (payload_length << 8U) | bytes[index+i];
+        }
+        const size_t payload_index = index+info::header_length;
+        if(payload_length > info::max_payload_length || payload_index+payload_length > length ||
+           !decode_xor_delta(bytes+payload_index, payload_length, values, num_values)) {
             return false;
         }
+        index = payload_index+payload_length;
+        return true;
+    }
+
+    template<size_t num_values, size_t N>
+    inline bool parse_xor_delta(const array<uint8_t,N>& bytes, const size_t length, size_t& index,
+                                float (&values)[num_values]) {
+        return length <= N && parse_xor_delta(bytes.begin(), length, index, values);
+    }
 
-        return expected_crc == crc;
+
+    // Native format for links between hosts with the same memory layout and Endianness:
+    // schema hash (uint32), object representation of msg, optional CRC16 or CRC-32C of everything before - all in
+    // host byte order
+    // Only the bytes of the fields are copied - padding bytes inside Msg are sent as zeros.
+
+    namespace internal {
+        inline constexpr size_t native_checksum_size(const checksum_type checksum) {
+            return checksum == checksum_type::crc32c ? sizeof(uint32_t) :
+                   (checksum == checksum_type::crc16 ? sizeof(uint16_t) : 0);
+        }
+
+        // Checksum of the first length bytes in host byte order (zero-extended for CRC16)
+        inline uint32_t native_checksum(const checksum_type checksum, const uint8_t* bytes, const size_t length) {
+            return checksum == checksum_type::crc32c ? crc32c(bytes, length) :
+                   static_cast<uint32_t>(crc16_aug_ccitt(bytes, static_cast<uint32_t>(length)));
+        }
+    } // namespace microbuf::internal
+
+    // Bytes of Msg which belong to fields (adjacent fields are merged)
+    struct native_range {
+        size_t offset;
+        size_t size;
+    };
+
+    template<checksum_type checksum, class Msg, size_t N>
+    inline size_t to_native_bytes(const Msg& msg, const uint32_t schema_hash, array<uint8_t,N>& bytes,
+                                  const native_range* ranges, const size_t num_ranges) {
+        constexpr size_t crc_index = sizeof(schema_hash)+sizeof(Msg);
+        constexpr size_t crc_size = internal::native_checksum_size(checksum);
+        static_assert(N == crc_index+crc_size, "bytes has the wrong size");
+
+        memcpy(bytes.begin(), &schema_hash, sizeof(schema_hash));
+        // padding bytes of msg are indeterminate - they would leak memory content and change the CRC
+        uint8_t* const dest = bytes.begin()+sizeof(schema_hash);
+        const uint8_t* const source = reinterpret_cast<const uint8_t*>(&msg);
+        memset(dest, 0, sizeof(Msg));
+        for(size_t i=0; i<num_ranges; ++i) {
+            memcpy(dest+ranges[i].offset, source+ranges[i].offset, ranges[i].size);
+        }
+        if(checksum == checksum_type::crc16) {
+            const uint16_t crc = static_cast<uint16_t>(internal::native_checksum(checksum, bytes.begin(), crc_index));
+            memcpy(bytes.begin()+crc_index, &crc, crc_size);
+        } else if(checksum == checksum_type::crc32c) {
+            const uint32_t crc = internal::native_checksum(checksum, bytes.begin(), crc_index);
+            memcpy(bytes.begin()+crc_index, &crc, crc_size);
+        }
+        return N;
+    }
+
+    // Position of bool fields (or bool arrays) in a native message
+    struct native_bools {
+        size_t offset;
+        size_t num;
+    };
+
+    // Check schema hash and CRC of native data with length bytes and copy it to msg
+    // The bytes of all bool fields in Msg (given by bools) are checked before they are copied
+    template<checksum_type checksum, class Msg>
+    inline bool from_native_bytes(Msg& msg, const uint32_t schema_hash, const uint8_t* bytes, const size_t length,
+                                  const native_bools* bools, const size_t num_bool_fields) {
+        constexpr size_t crc_index = sizeof(schema_hash)+sizeof(Msg);
+        if(length != crc_index+internal::native_checksum_size(checksum)) {
+            return false;
+        }
+
+        uint32_t received_schema_hash;
+        memcpy(&received_schema_hash, bytes, sizeof(received_schema_hash));
+        if(received_schema_hash != schema_hash) {
+            return false;
+        }
+        if(checksum == checksum_type::crc16) {
+            uint16_t crc;
+            memcpy(&crc, bytes+crc_index, sizeof(crc));
+            if(crc != internal::native_checksum(checksum, bytes, crc_index)) {
+                return false;
+            }
+        } else if(checksum == checksum_type::crc32c) {
+            uint32_t crc;
+            memcpy(&crc, bytes+crc_index, sizeof(crc));
+            if(crc != internal::native_checksum(checksum, bytes, crc_index)) {
+                return false;
+            }
+        }
+        for(size_t i=0; i<num_bool_fields; ++i) {
+            for(size_t j=0; j<bools[i].num; ++j) {
+                if(bytes[sizeof(schema_hash)+bools[i].offset+j] > 1) {
+                    return false;
+                }
+            }
+        }
+
+        memcpy(&msg, bytes+sizeof(schema_hash), sizeof(Msg));
+        return true;
     }
 
 }
@@ -0,0 +1,143 @@
+#ifndef MICROBUF_MICROBUF_CONTAINER_H
+#define MICROBUF_MICROBUF_CONTAINER_H
+
+// Pack many serialized messages into one buffer (e.g. one UDP datagram) and walk through them on the receiver side
+//
+// A container is a sequence of msgpack ext16 objects, one per message:
+//   0xc8, length (uint16, Big Endian), type (0..127, chosen by the application), serialized message
+// The type allows the receiver to tell messages apart, e.g. by using one type per message struct.
+
+#include "microbuf.h"
+
+namespace microbuf {
+
+    namespace internal {
+        static const size_t container_header_length = 4;
+        static const uint8_t container_prefix = 0xc8;
+    }
+
+    // Collects serialized messages in a buffer of max_size bytes (e.g. the maximum UDP payload)
+    // The buffer is handed to the flush function when the next message would not fit anymore, when the first
+    // message in it has waited for max_delay, or when flush() is called.
+    // Times are given by the caller in any unit (e.g. millis() on Arduino) and may wrap around.
+    template<size_t max_size>
+    class container_writer {
+        static_assert(max_size > internal::container_header_length, "max_size too small");
+
+    public:
+        using flush_function = void (*)(const uint8_t* bytes, size_t length, void* context);
+
+        container_writer(flush_function flush, void* context, const uint32_t max_delay)
+            : flush_(flush), context_(context), max_delay_(max_delay) {}
+
+        // Append serialized message with length bytes
+        // Returns false if the message can never fit into a container or type is larger than 127
+        bool add(const uint8_t type, const uint8_t* bytes, const size_t length, const uint32_t now) {
+            using namespace internal;
+            if(type > 127 || length > 0xffffU || container_header_length+length > max_size) {
+                return false;
+            }
+            if(length_+container_header_length+length > max_size) {
+                flush();
+            }
+            if(num_messages_ == 0) {
+                first_time_ = now;
+            }
+
+            uint8_t* entry = buffer_.begin()+length_;
+            entry[0] = container_prefix;
+            entry[1] = static_cast<uint8_t>(length >> 8U);
+            entry[2] = static_cast<uint8_t>(length);
+            entry[3] = type;
+            memcpy(entry+container_header_length, bytes, length);
+            length_ += container_header_length+length;
+            ++num_messages_;
+
+            poll(now);
+            return true;
+        }
+
+        template<size_t N>
+        bool add(const uint8_t type, const array<uint8_t,N>& bytes, const uint32_t now) {
+            return add(type, bytes.begin(), N, now);
+        }
+
+        // Serialize a generated message struct and append it
+        template<class Msg>
+        bool add_message(const uint8_t type, const Msg& msg, const uint32_t now) {
+            array<uint8_t, Msg::data_size> bytes;
+            const size_t length = msg.to_bytes(bytes);
+            return add(type, bytes.begin(), length, now);
+        }
+
+        // Flush if the first message has waited long enough - call regularly
+        void poll(const uint32_t now) {
+            if(num_messages_ > 0 && static_cast<uint32_t>(now-first_time_) >= max_delay_) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if(num_messages_ == 0) {
+                return;
+            }
+            flush_(buffer_.begin(), length_, context_);
+            length_ = 0;
+            num_messages_ = 0;
+        }
+
+        size_t size() const { return length_; }
+        size_t num_messages() const { return num_messages_; }
+
+    private:
+        flush_function flush_;
+        void* context_;
+        uint32_t max_delay_;
+        uint32_t first_time_ {0};
+        size_t length_ {0};
+        size_t num_messages_ {0};
+        array<uint8_t, max_size> buffer_ {};
+    };
+
+    // Walk through the messages of a received container without copying them
+    class container_reader {
+    public:
+        container_reader(const uint8_t* bytes, const size_t length)
+            : bytes_(bytes), length_(length) {}
+
+        // Get the next message - returns false at the end of the container or if it is malformed (see error())
+        // bytes points into the container
+        bool next(uint8_t& type, const uint8_t*& bytes, size_t& length) {
+            using namespace internal;
+            if(position_ == length_ || error_) {
+                return false;
+            }
+            const uint8_t* entry = bytes_+position_;
+            if(length_-position_ < container_header_length || entry[0] != container_prefix) {
+                error_ = true;
+                return false;
+            }
+            const size_t entry_length = static_cast<size_t>(entry[1]) << 8U | entry[2];
+            if(length_-position_-container_header_length < entry_length) {
+                error_ = true;
+                return false;
+            }
+            type = entry[3];
+            bytes = entry+container_header_length;
+            length = entry_length;
+            position_ += container_header_length+entry_length;
+            return true;
+        }
+
+        bool error() const { return error_; }
+
+    private:
+        const uint8_t* bytes_;
+        size_t length_;
+        size_t position_ {0};
+        bool error_ {false};
+    };
+
+}
+
+#endif //MICROBUF_MICROBUF_CONTAINER_H
@@ -0,0 +1,180 @@
+#ifndef MICROBUF_MICROBUF_EPOLL_RECEIVER_H
+#define MICROBUF_MICROBUF_EPOLL_RECEIVER_H
+
+// Linux only: receive datagrams with epoll and publish decoded messages to latest<Msg> mailboxes
+
+#include "microbuf.h"
+#include "microbuf_latest.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace microbuf {
+
+    // Receive loop for datagram sockets (e.g. UDP)
+    // Each registered socket is bound to one mailbox. Every datagram with at most Msg::data_size bytes for which
+    // Msg::from_bytes() succeeds is published to that mailbox; everything else is counted as rejected.
+    // add() must not be called while another thread is inside poll() or run(); stop() may be called from anywhere.
+    class epoll_receiver {
+    public:
+        epoll_receiver() {
+            epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+            stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if(epoll_fd_ >= 0 && stop_fd_ >= 0) {
+                epoll_event event {};
+                event.events = EPOLLIN;
+                event.data.u64 = stop_token;
+                if(::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event) != 0) {
+                    close_fds();
+                }
+            } else {
+                close_fds();
+            }
+        }
+
+        ~epoll_receiver() { close_fds(); }
+
+        epoll_receiver(const epoll_receiver&) = delete;
+        epoll_receiver& operator=(const epoll_receiver&) = delete;
+
+        bool is_open() const { return epoll_fd_ >= 0; }
+
+        // Register socket_fd (not owned by the receiver) - mailbox must outlive the receiver
+        template<class Msg>
+        bool add(const int socket_fd, latest<Msg>& mailbox) {
+            if(!is_open()) {
+                return false;
+            }
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.u64 = sources_.size();
+            if(::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_fd, &event) != 0) {
+                return false;
+            }
+            sources_.push_back(source{socket_fd, &mailbox, &receive_all<Msg>});
+            return true;
+        }
+
+        // Wait up to timeout_ms (-1: forever) and handle all datagrams which are available
+        // Returns the number of published messages or -1 if epoll failed or stop() was called
+        // Receive errors of single sockets are only counted (see num_receive_errors())
+        int poll(const int timeout_ms) {
+            if(!is_open()) {
+                return -1;
+            }
+            epoll_event events[max_events];
+            int num_events;
+            do {
+                num_events = ::epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+            } while(num_events < 0 && errno == EINTR);
+            if(num_events < 0) {
+                return -1;
+            }
+
+            int num_published = 0;
+            bool stopped = false;
+            for(int i=0; i<num_events; ++i) {
+                if(events[i].data.u64 == stop_token) {
+                    // reset the counter so the receiver can be used again
+                    uint64_t value;
+                    const ssize_t res = ::read(stop_fd_, &value, sizeof(value));
+                    (void) res; // nothing to read if another thread was faster
+                    stopped = true;
+                    continue;
+                }
+                const source& src = sources_[events[i].data.u64];
+                bool receive_error = false;
+                num_published += src.receive(src.fd, src.mailbox, num_rejected_, receive_error);
+                if(receive_error) {
+                    // e.g. ECONNREFUSED on a connected UDP socket - the other sockets are not affected
+                    num_receive_errors_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            // messages of this call are published even if stop() was called meanwhile
+            num_published_.fetch_add(static_cast<uint64_t>(num_published), std::memory_order_relaxed);
+            return stopped ? -1 : num_published;
+        }
+
+        // Handle datagrams until stop() is called or epoll fails
+        void run() {
+            while(poll(-1) >= 0) {}
+        }
+
+        // Make a running poll()/run() (or the next one) return - safe to call from any thread
+        // The receiver can be used again afterwards.
+        void stop() {
+            const uint64_t one = 1;
+            const ssize_t res = ::write(stop_fd_, &one, sizeof(one));
+            (void) res; // if the counter is already set, run() will stop anyway
+        }
+
+        uint64_t num_published() const { return num_published_.load(std::memory_order_relaxed); }
+        uint64_t num_rejected() const { return num_rejected_.load(std::memory_order_relaxed); }
+        uint64_t num_receive_errors() const { return num_receive_errors_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint64_t stop_token = ~static_cast<uint64_t>(0);
+        static constexpr int max_events = 16;
+
+        struct source {
+            int fd;
+            void* mailbox;
+            int (*receive)(int fd, void* mailbox, std::atomic<uint64_t>& num_rejected, bool& receive_error);
+        };
+
+        // Drain all pending datagrams of fd into the mailbox - returns the number of published messages,
+        // receive_error is set if recv() failed (messages published before are still counted)
+        template<class Msg>
+        static int receive_all(const int fd, void* const mailbox_ptr, std::atomic<uint64_t>& num_rejected,
+                               bool& receive_error) {
+            latest<Msg>& mailbox = *static_cast<latest<Msg>*>(mailbox_ptr);
+            array<uint8_t, Msg::data_size> bytes;
+            int num_published = 0;
+            for(;;) {
+                // MSG_TRUNC: return the real datagram length so too long datagrams are detected
+                const ssize_t len = ::recv(fd, bytes.begin(), bytes.size(), MSG_DONTWAIT | MSG_TRUNC);
+                if(len < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    receive_error = errno != EAGAIN && errno != EWOULDBLOCK;
+                    return num_published;
+                }
+                // decode straight into the writer's buffer - it only becomes visible with publish()
+                if(static_cast<size_t>(len) > Msg::data_size ||
+                   !mailbox.back().from_bytes(bytes.begin(), static_cast<size_t>(len))) {
+                    num_rejected.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                mailbox.publish();
+                ++num_published;
+            }
+        }
+
+        void close_fds() {
+            if(epoll_fd_ >= 0) {
+                ::close(epoll_fd_);
+                epoll_fd_ = -1;
+            }
+            if(stop_fd_ >= 0) {
+                ::close(stop_fd_);
+                stop_fd_ = -1;
+            }
+        }
+
+        int epoll_fd_ {-1};
+        int stop_fd_ {-1};
+        std::vector<source> sources_ {};
+        std::atomic<uint64_t> num_published_ {0};
+        std::atomic<uint64_t> num_rejected_ {0};
+        std::atomic<uint64_t> num_receive_errors_ {0};
+    };
+
+}
+
+#endif //MICROBUF_MICROBUF_EPOLL_RECEIVER_H
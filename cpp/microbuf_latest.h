@@ -0,0 +1,77 @@
+#ifndef MICROBUF_MICROBUF_LATEST_H
+#define MICROBUF_MICROBUF_LATEST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace microbuf {
+
+    // Wait-free single-producer/single-consumer mailbox which only keeps the newest value (triple buffer)
+    // The writer fills back(), then calls publish(). The reader calls update() and then reads front().
+    // Neither side ever blocks or waits for the other one - stale values are simply overwritten.
+    template<class Msg>
+    class latest {
+    public:
+        latest() = default;
+        latest(const latest&) = delete;
+        latest& operator=(const latest&) = delete;
+
+        // --- writer side ---
+
+        // Buffer which the writer may fill before calling publish()
+        Msg& back() { return slots_[back_].msg; }
+
+        // Make the content of back() available to the reader
+        void publish() {
+            back_ = static_cast<uint8_t>(
+                    middle_.exchange(static_cast<uint8_t>(back_ | new_data_bit), std::memory_order_acq_rel) & index_mask);
+        }
+
+        void publish(const Msg& msg) {
+            back() = msg;
+            publish();
+        }
+
+        // --- reader side ---
+
+        // Fetch newest published value into front() - returns false if nothing was published since the last call
+        bool update() {
+            if((middle_.load(std::memory_order_relaxed) & new_data_bit) == 0) {
+                return false;
+            }
+            front_ = static_cast<uint8_t>(middle_.exchange(front_, std::memory_order_acq_rel) & index_mask);
+            return true;
+        }
+
+        // Newest value fetched by update() (value-initialized Msg until the first successful update())
+        const Msg& front() const { return slots_[front_].msg; }
+
+        // Copy newest value to result if there is a new one
+        bool read(Msg& result) {
+            if(!update()) {
+                return false;
+            }
+            result = front();
+            return true;
+        }
+
+    private:
+        static constexpr uint8_t index_mask = 0x03U;
+        static constexpr uint8_t new_data_bit = 0x04U;
+        static constexpr size_t cache_line_size = 64;
+
+        // each slot on its own cache line(s) so writer and reader do not share lines
+        struct alignas(cache_line_size) slot {
+            Msg msg {};
+        };
+
+        slot slots_[3] {};
+        alignas(cache_line_size) std::atomic<uint8_t> middle_ {1}; // index of buffer in the middle + new_data_bit
+        alignas(cache_line_size) uint8_t back_ {0};                 // only touched by the writer
+        alignas(cache_line_size) uint8_t front_ {2};                // only touched by the reader
+    };
+
+}
+
+#endif //MICROBUF_MICROBUF_LATEST_H
@@ -0,0 +1,138 @@
+#ifndef MICROBUF_MICROBUF_PARALLEL_H
+#define MICROBUF_MICROBUF_PARALLEL_H
+
+#include "microbuf.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace microbuf {
+
+    // Small fixed-size thread pool: Executor for the parallel functions in microbuf.h, e.g. the generated
+    // to_bytes(bytes, executor) and from_bytes(bytes, length, executor) of messages with "parallel: yes"
+    // The calling thread also works on the tasks of parallel_for(), so num_threads additional threads are started.
+    // parallel_for() may be called from several threads - the calls are run one after another.
+    class thread_pool {
+    public:
+        explicit thread_pool(const size_t num_threads = default_num_threads()) {
+            workers_.reserve(num_threads);
+            for(size_t i=0; i<num_threads; ++i) {
+                workers_.emplace_back([this]() { work(); });
+            }
+        }
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock {mutex_};
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for(std::thread& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        // One thread less than the hardware supports, as the calling thread works as well
+        static size_t default_num_threads() {
+            const size_t num_cores = std::thread::hardware_concurrency();
+            return num_cores > 1 ? num_cores-1 : 0;
+        }
+
+        size_t num_threads() const { return workers_.size(); }
+
+        // Call f(task) for all task < num_tasks, wait for all of them and return whether all returned true
+        template<typename F>
+        bool parallel_for(const size_t num_tasks, F f) {
+            if(num_tasks <= 1 || workers_.empty()) {
+                return serial_executor {}.parallel_for(num_tasks, f);
+            }
+
+            std::lock_guard<std::mutex> run_lock {run_mutex_};
+            const std::function<bool(size_t)> task_function {[&f](const size_t task) { return f(task); }};
+            {
+                // workers which are still busy with the previous tasks would read the new ones
+                std::unique_lock<std::mutex> lock {mutex_};
+                done_.wait(lock, [this]() { return num_active_ == 0; });
+                task_function_ = &task_function;
+                num_tasks_ = num_tasks;
+                num_done_ = 0;
+                next_task_.store(0, std::memory_order_relaxed);
+                worked_.store(true, std::memory_order_relaxed);
+                ++generation_;
+            }
+            wake_.notify_all();
+
+            run_tasks();
+
+            std::unique_lock<std::mutex> lock {mutex_};
+            done_.wait(lock, [this]() { return num_done_ == num_tasks_; });
+            return worked_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void work() {
+            uint64_t seen_generation = 0;
+            for(;;) {
+                {
+                    std::unique_lock<std::mutex> lock {mutex_};
+                    wake_.wait(lock, [&]() { return stop_ || generation_ != seen_generation; });
+                    if(stop_) {
+                        return;
+                    }
+                    seen_generation = generation_;
+                    ++num_active_;
+                }
+                run_tasks();
+                {
+                    std::lock_guard<std::mutex> lock {mutex_};
+                    --num_active_;
+                }
+                done_.notify_all();
+            }
+        }
+
+        // Take tasks until none are left - the task function and number of tasks do not change meanwhile
+        void run_tasks() {
+            size_t num_finished = 0;
+            for(size_t task = next_task_.fetch_add(1, std::memory_order_relaxed); task < num_tasks_;
+                task = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+                if(!(*task_function_)(task)) {
+                    worked_.store(false, std::memory_order_relaxed);
+                }
+                ++num_finished;
+            }
+            if(num_finished > 0) {
+                {
+                    std::lock_guard<std::mutex> lock {mutex_};
+                    num_done_ += num_finished;
+                }
+                done_.notify_all();
+            }
+        }
+
+        std::vector<std::thread> workers_;
+        std::mutex run_mutex_;                 // one parallel_for() at a time
+        std::mutex mutex_;                     // protects all of the following except the atomics
+        std::condition_variable wake_;         // new tasks or stop
+        std::condition_variable done_;         // tasks finished or worker idle
+        const std::function<bool(size_t)>* task_function_ {nullptr};
+        size_t num_tasks_ {0};
+        size_t num_done_ {0};
+        size_t num_active_ {0};                // workers which may still take tasks
+        uint64_t generation_ {0};              // incremented for each parallel_for()
+        bool stop_ {false};
+        std::atomic<size_t> next_task_ {0};
+        std::atomic<bool> worked_ {true};
+    };
+
+}
+
+#endif //MICROBUF_MICROBUF_PARALLEL_H
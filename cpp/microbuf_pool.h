@@ -0,0 +1,137 @@
+#ifndef MICROBUF_MICROBUF_POOL_H
+#define MICROBUF_MICROBUF_POOL_H
+
+#include "microbuf.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace microbuf {
+
+    struct pool_statistics {
+        size_t capacity;
+        size_t in_use;           // slots acquired and not released yet
+        size_t high_water_mark;  // maximum of in_use since construction or reset_high_water_mark()
+        size_t failed_acquires;  // acquire() calls which found no free slot
+    };
+
+    // Fixed arena of capacity slots, each holding a message and a buffer for its serialized bytes
+    // Slots are handed out and recycled through a lock-free free list, so acquire() and release() never allocate
+    // and may be called from any thread. Each slot starts on its own cache line.
+    // The pool itself should live in static storage (or be allocated with C++17 aligned new) - it contains the arena.
+    template<class Msg, size_t capacity>
+    class pool {
+    public:
+        static constexpr size_t cache_line_size = 64;
+
+        struct alignas(cache_line_size) slot {
+            Msg msg {};
+            array<uint8_t,Msg::data_size> bytes {};
+            size_t length {0}; // number of valid bytes
+
+            // Serialize msg into bytes - returns the number of used bytes
+            size_t serialize() {
+                length = msg.to_bytes(bytes);
+                return length;
+            }
+
+            // Deserialize the first length bytes (e.g. after receiving into bytes) into msg
+            bool deserialize() {
+                return msg.from_bytes(bytes.begin(), length);
+            }
+        };
+
+        // Releases a slot to its pool when the unique_ptr goes out of scope
+        class releaser {
+        public:
+            explicit releaser(pool* owner = nullptr) : owner_ {owner} {}
+            void operator()(slot* s) const { owner_->release(s); }
+        private:
+            pool* owner_;
+        };
+        using unique_slot = std::unique_ptr<slot, releaser>;
+
+        pool() {
+            static_assert(capacity > 0 && capacity < empty_index, "capacity out of range");
+            for(size_t i=0; i<capacity; ++i) {
+                next_[i].store(static_cast<uint32_t>(i+1 < capacity ? i+1 : empty_index), std::memory_order_relaxed);
+            }
+            head_.store(0, std::memory_order_release);
+        }
+
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+
+        // Take a free slot (with the content it had when it was released) - nullptr if all slots are in use
+        slot* acquire() {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            uint32_t index;
+            do {
+                index = static_cast<uint32_t>(head);
+                if(index == empty_index) {
+                    failed_acquires_.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                // next_[index] may be outdated if the slot was taken meanwhile - then the tag differs and CAS fails
+            } while(!head_.compare_exchange_weak(head, tagged(head, next_[index].load(std::memory_order_relaxed)),
+                                                 std::memory_order_acquire, std::memory_order_acquire));
+
+            const size_t in_use = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+            size_t high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+            while(in_use > high_water_mark &&
+                  !high_water_mark_.compare_exchange_weak(high_water_mark, in_use, std::memory_order_relaxed)) {
+            }
+            return &slots_[index];
+        }
+
+        // Like acquire(), but the slot is released automatically
+        unique_slot acquire_unique() {
+            return unique_slot {acquire(), releaser {this}};
+        }
+
+        // Give a slot from acquire() back to the pool
+        void release(slot* s) {
+            if(s == nullptr) {
+                return;
+            }
+            // count down first so in_use never exceeds capacity when the slot is taken again right away
+            in_use_.fetch_sub(1, std::memory_order_relaxed);
+            const uint32_t index = static_cast<uint32_t>(s - slots_);
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            do {
+                next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while(!head_.compare_exchange_weak(head, tagged(head, index), std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        }
+
+        pool_statistics statistics() const {
+            return pool_statistics {capacity, in_use_.load(std::memory_order_relaxed),
+                                    high_water_mark_.load(std::memory_order_relaxed),
+                                    failed_acquires_.load(std::memory_order_relaxed)};
+        }
+
+        void reset_high_water_mark() {
+            high_water_mark_.store(in_use_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr uint32_t empty_index = UINT32_MAX;
+
+        // Head of the free list: index of the first free slot in the lower 32 bits and a tag in the upper 32 bits,
+        // which changes with every update so a CAS with an outdated head fails (ABA problem)
+        static uint64_t tagged(const uint64_t old_head, const uint32_t index) {
+            return ((old_head >> 32U) + 1U) << 32U | index;
+        }
+
+        slot slots_[capacity];
+        std::atomic<uint32_t> next_[capacity];     // next free slot after each free slot
+        alignas(cache_line_size) std::atomic<uint64_t> head_ {empty_index};
+        alignas(cache_line_size) std::atomic<size_t> in_use_ {0};
+        std::atomic<size_t> high_water_mark_ {0};
+        std::atomic<size_t> failed_acquires_ {0};
+    };
+
+}
+
+#endif //MICROBUF_MICROBUF_POOL_H
@@ -3,6 +3,7 @@
 #include <Wire.h>
 
 uint8_t msg_counter = 0;
+const size_t max_transmission_size = 32; // size of the Wire buffer
 
 void setup()
 {
@@ -22,9 +23,13 @@ void loop() {
   msg_counter++; // will overflow and start at 0 again
 
   const auto bytes = msg.as_bytes();
-  Wire.beginTransmission(2);
-  Wire.write(bytes.data, bytes.size());
-  Wire.endTransmission();
+  // Wire can only send 32 bytes at once - larger messages are split into several transmissions
+  for(size_t offset=0; offset<bytes.size(); offset+=max_transmission_size) {
+    const size_t remaining = bytes.size() - offset;
+    Wire.beginTransmission(2);
+    Wire.write(bytes.data + offset, remaining < max_transmission_size ? remaining : max_transmission_size);
+    Wire.endTransmission();
+  }
   
   Serial.print("- Tried to send ");
   Serial.print(bytes.size());
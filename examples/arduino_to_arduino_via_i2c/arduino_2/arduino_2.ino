@@ -1,10 +1,11 @@
 #include "ArduinoMessage.h"
 #include <Wire.h>
 
-ArduinoMessage_struct_t msg {};
-
-microbuf::array<uint8_t,ArduinoMessage_struct_t::data_size> bytes {}; // storage for received data
-bool newDataReceived = false;
+ArduinoMessage_struct_t incoming {}; // received bytes are decoded directly into this struct (may be incomplete)
+ArduinoMessage_struct_t msg {};      // last valid message - only written when a message is complete
+microbuf::push_state state {};       // position and CRC of the push parser
+volatile bool newDataReceived = false;
+volatile bool conversionWorked = false;
 
 void setup()
 {
@@ -16,31 +17,42 @@ void setup()
 void loop()
 {
   if(newDataReceived) {
-    bool worked = msg.from_bytes(bytes);
+    // receiveEvent() runs in an interrupt - take a consistent copy
+    noInterrupts();
+    const ArduinoMessage_struct_t received = msg;
+    const bool worked = conversionWorked;
+    newDataReceived = false;
+    interrupts();
+
     Serial.print("Received new data - conversion worked: ");
     Serial.print(worked);
-    Serial.print(", message counter: ");
-    Serial.println(msg.message_counter);
-    newDataReceived = false;  
+    Serial.print(", message counter of last valid message: ");
+    Serial.println(received.message_counter);
   }
 }
 
 void receiveEvent(int howMany)
 {
-  size_t num_read = 0;
-  while(Wire.available() && num_read <= ArduinoMessage_struct_t::data_size) {
-    bytes[num_read] = Wire.read();  
-    ++num_read;
-  }
-  //Serial.print("read n bytes: "); Serial.println(num_read);
-  
-  if(num_read == ArduinoMessage_struct_t::data_size) {
-    // correct size received
-    newDataReceived = true;
-  }
-  
-  // discard rest of the data if there is any
+  // a message may be split over several transmissions - state is kept until the message is complete or invalid
   while(Wire.available()) {
-    Wire.read();  
+    const uint8_t value = Wire.read();
+    // fields and CRC are checked as the bytes arrive - no buffer for the serialized message needed
+    microbuf::push_result result = incoming.push_byte(state, value);
+    if(result == microbuf::push_result::failed) {
+      // e.g. a lost transmission: the wrong byte may be the start of the next message
+      state.reset();
+      result = incoming.push_byte(state, value);
+      conversionWorked = false;
+      newDataReceived = true;
+    }
+    if(result == microbuf::push_result::failed) {
+      state.reset();
+    } else if(result == microbuf::push_result::done) {
+      // only a complete message with a valid CRC is handed to loop()
+      msg = incoming;
+      conversionWorked = true;
+      newDataReceived = true;
+      state.reset();
+    }
   }
 }
@@ -28,6 +28,17 @@ class PlainTypes:
         float64: 1 + 8
     }
 
+    native_size = {
+        # size (and alignment) in bytes of each plain field in the native format
+        bool: 1,
+        uint8: 1,
+        uint16: 2,
+        uint32: 4,
+        uint64: 8,
+        float32: 4,
+        float64: 8
+    }
+
     all = (bool, uint8, uint16, uint32, uint64, float32, float64)  # simplify this?
 
 
@@ -49,11 +60,57 @@ class ArrayTypes:
     }
 
 
+class BinTypes:
+    bin8 = "bin8"
+    bin16 = "bin16"
+    bin32 = "bin32"
+
+    storage_size = {
+        # storage size in bytes of the header (prefix and length)
+        bin8: 1 + 1,
+        bin16: 1 + 2,
+        bin32: 1 + 4
+    }
+
+    max_length = {
+        bin8: 255,
+        bin16: 65535,
+        bin32: 4294967295
+    }
+
+    @staticmethod
+    def get_bin_type(payload_length: int):
+        for bin_type in (BinTypes.bin8, BinTypes.bin16, BinTypes.bin32):
+            if payload_length <= BinTypes.max_length[bin_type]:
+                return bin_type
+        logging.error("Binary payload of {} bytes is too large".format(payload_length))
+        sys.exit(1)
+
+
+class FieldEncodings:
+    xor_delta = "xor_delta"
+
+    all = (xor_delta,)
+
+
+class ChecksumTypes:
+    crc16 = "crc16"
+    crc32c = "crc32c"
+
+    # checksums are stored as msgpack uint of this type
+    value_type = {
+        crc16: PlainTypes.uint16,
+        crc32c: PlainTypes.uint32
+    }
+
+    all = (crc16, crc32c)
+
+
 class MessageField(ABC):
     """ Abstract class: field inside a message"""
 
     @abstractmethod
-    def __init__(self, field_name: str):
+    def __init__(self, field_name: str, optional: bool = False):
         # check field name
         allowed_chars = set(string.ascii_lowercase + string.ascii_uppercase + string.digits + '_')
         if set(field_name) > allowed_chars:
@@ -70,6 +127,7 @@ class MessageField(ABC):
             sys.exit(1)
 
         self.name = field_name
+        self.optional = optional  # only sent if present (see presence bitmap of the message)
 
     @abstractmethod
     def get_num_of_plain_fields(self):
@@ -78,15 +136,27 @@ class MessageField(ABC):
 
     @abstractmethod
     def get_num_of_bytes(self):
-        """ Return number of bytes needed for storing this field in the serialized format """
+        """ Return number of bytes needed for storing this field in the serialized format (at most) """
         pass
 
+    def get_min_num_of_bytes(self):
+        """ Return minimum number of bytes needed for storing this field in the serialized format """
+        if self.optional:
+            return 0
+        return self._get_min_num_of_bytes_if_present()
+
+    def _get_min_num_of_bytes_if_present(self):
+        return self.get_num_of_bytes()
+
+    def has_variable_size(self):
+        return self.get_min_num_of_bytes() != self.get_num_of_bytes()
+
 
 class MessageFieldPlain(MessageField):
     """ Field inside a message with a plain data type (e.g. float32) """
 
-    def __init__(self, field_name: str, field_type: str):
-        super().__init__(field_name)
+    def __init__(self, field_name: str, field_type: str, optional: bool = False):
+        super().__init__(field_name, optional)
 
         if field_type not in PlainTypes.all:
             logging.error("Field type '{}' of field '{}' is unknown".format(field_type, field_name))
@@ -104,8 +174,8 @@ class MessageFieldPlain(MessageField):
 class MessageFieldPlainArray(MessageFieldPlain):
     """ Field inside a message which contains an array of plain data types (e.g. float32[4]) """
 
-    def __init__(self, field_name: str, field_type: str, array_length: int):
-        super().__init__(field_name, field_type)
+    def __init__(self, field_name: str, field_type: str, array_length: int, optional: bool = False):
+        super().__init__(field_name, field_type, optional)
 
         if array_length < 1:
             logging.error("Field '{}' must have a length of at least 1 (has: {})".format(field_name, array_length))
@@ -121,19 +191,86 @@ class MessageFieldPlainArray(MessageFieldPlain):
         return self.array_length * PlainTypes.storage_size[self.type]
 
 
+class MessageFieldEncodedArray(MessageFieldPlainArray):
+    """ Field inside a message which contains an array stored with a special encoding as msgpack bin
+    (e.g. float32[64] @xor_delta) """
+
+    def __init__(self, field_name: str, field_type: str, array_length: int, encoding: str, optional: bool = False):
+        super().__init__(field_name, field_type, array_length, optional)
+
+        if encoding not in FieldEncodings.all:
+            logging.error("Encoding '{}' of field '{}' is unknown".format(encoding, field_name))
+            sys.exit(1)
+
+        if field_type != PlainTypes.float32:
+            logging.error("Encoding '{}' of field '{}' is only supported for float32 arrays".format(encoding,
+                                                                                                  field_name))
+            sys.exit(1)
+
+        self.encoding = encoding
+
+    def get_num_of_plain_fields(self):
+        # stored as a single bin object
+        return 1
+
+    def get_max_payload_length(self):
+        # mode byte and, in the worst case, all values without compression
+        return 1 + self.array_length * 4
+
+    def get_bin_type(self):
+        return BinTypes.get_bin_type(self.get_max_payload_length())
+
+    def get_num_of_bytes(self):
+        return BinTypes.storage_size[self.get_bin_type()] + self.get_max_payload_length()
+
+    def _get_min_num_of_bytes_if_present(self):
+        # mode byte and the first value
+        return BinTypes.storage_size[self.get_bin_type()] + 1 + 4
+
+
 class Message:
-    def __init__(self, name: str, version: int, append_checksum: bool):
+    def __init__(self, name: str, version: int, append_checksum: bool, native_format: bool = False,
+                 parallel: bool = False, checksum: str = ChecksumTypes.crc16):
         self.name = name
         self.version = version
         self.append_checksum = append_checksum
+        self.checksum = checksum  # type of the checksum if append_checksum
+        self.native_format = native_format
+        self.parallel = parallel  # only for messages without fields of variable size
         self.fields = []  # type: typing.List[MessageField]
 
+    # Maximum number of optional fields and the type of the presence bitmap
+    MAX_NUM_OPTIONAL_FIELDS = 64
+    PRESENCE_FIELD_NAME = "presence"
+
     def add_field(self, field: MessageField):
         # it makes not much sense to check whether a field with field_name already exists here as duplicate keys
         # are silently ignored by the YAML loading
 
         self.fields.append(field)
 
+        if len(self.get_optional_fields()) > Message.MAX_NUM_OPTIONAL_FIELDS:
+            logging.error("Message '{}' has more than {} optional fields".format(self.name,
+                                                                               Message.MAX_NUM_OPTIONAL_FIELDS))
+            sys.exit(1)
+
+        if self.get_optional_fields() and any(f.name == Message.PRESENCE_FIELD_NAME for f in self.fields):
+            logging.error("The field name '{}' is reserved in messages with optional fields".format(
+                Message.PRESENCE_FIELD_NAME))
+            sys.exit(1)
+
+    def get_optional_fields(self):
+        return [field for field in self.fields if field.optional]
+
+    def get_presence_type(self):
+        """ Type of the presence bitmap (bit i: i-th optional field is present) or None without optional fields """
+        num_optional_fields = len(self.get_optional_fields())
+        if num_optional_fields == 0:
+            return None
+        for presence_type in (PlainTypes.uint8, PlainTypes.uint16, PlainTypes.uint32, PlainTypes.uint64):
+            if num_optional_fields <= 8 * PlainTypes.native_size[presence_type]:
+                return presence_type
+
     def get_num_of_plain_fields(self):
         """ Calculate number of plain/flat fields
         """
@@ -141,6 +278,9 @@ class Message:
         for field in self.fields:
             num = num + field.get_num_of_plain_fields()
 
+        if self.get_presence_type() is not None:
+            num = num + 1
+
         # do not count checksum field at the end b/c it's not part of the main array
 
         return num
@@ -159,18 +299,50 @@ class Message:
             sys.exit(1)
 
     def get_num_of_bytes(self):
-        """ Calculate number of bytes needed to store this message (excluding a possible CRC value)
+        """ Calculate number of bytes needed to store this message (in the worst case, including a possible CRC value)
         """
-        num_bytes = 0
-        for field in self.fields:
-            num_bytes = num_bytes + field.get_num_of_bytes()
+        return self._get_num_of_bytes([field.get_num_of_bytes() for field in self.fields])
+
+    def get_min_num_of_bytes(self):
+        """ Calculate minimum number of bytes needed to store this message (including a possible CRC value)
+        """
+        return self._get_num_of_bytes([field.get_min_num_of_bytes() for field in self.fields])
+
+    def has_variable_size(self):
+        return any(field.has_variable_size() for field in self.fields)
+
+    def get_checksum_value_type(self):
+        """ Plain type in which the checksum is stored """
+        return ChecksumTypes.value_type[self.checksum]
 
-        # add size of leading array
+    def get_schema_hash(self):
+        """ Calculate 32 bit FNV-1a hash of name, version, checksum and data fields (not their encoding) """
+        description = "{};{};{};".format(self.name, self.version, self.checksum if self.append_checksum else "")
+        for field in self.fields:
+            field = typing.cast(MessageFieldPlain, field)
+            description += "{}:{}".format(field.name, field.type)
+            if isinstance(field, MessageFieldPlainArray):
+                description += "[{}]".format(field.array_length)
+            if field.optional:
+                description += "?"
+            description += ";"
+
+        schema_hash = 0x811c9dc5
+        for byte in description.encode("utf-8"):
+            schema_hash = ((schema_hash ^ byte) * 0x01000193) & 0xffffffff
+        return schema_hash
+
+    def _get_num_of_bytes(self, field_sizes: typing.List[int]):
+        num_bytes = sum(field_sizes)
+
+        # add size of leading array and presence bitmap
         num_bytes = num_bytes + ArrayTypes.storage_size[self.get_main_array_type()]
+        if self.get_presence_type() is not None:
+            num_bytes = num_bytes + PlainTypes.storage_size[self.get_presence_type()]
 
         if self.append_checksum:
             # also count checksum field at the end b/c it needs storage space
-            num_bytes = num_bytes + PlainTypes.storage_size[PlainTypes.uint16]
+            num_bytes = num_bytes + PlainTypes.storage_size[self.get_checksum_value_type()]
 
         return num_bytes
 
@@ -195,6 +367,15 @@ class ArrayTypeHandler:
         self.deserialization_fun = deserialization_fun
 
 
+class ChecksumHandler:
+    """
+    Abstraction of how to add and check checksums
+    """
+    def __init__(self, serialization_fun: str, deserialization_fun: str):
+        self.serialization_fun = serialization_fun
+        self.deserialization_fun = deserialization_fun
+
+
 class CppInterfaceGenerator:
     DATA_TYPE_LOOKUP = {
         # Regarding init value: values will be initialized with {}
@@ -214,6 +395,11 @@ class CppInterfaceGenerator:
         ArrayTypes.array32: ArrayTypeHandler("gen_array32", "check_array32")
     }
 
+    CHECKSUM_LOOKUP = {
+        ChecksumTypes.crc16: ChecksumHandler("append_crc", "verify_crc"),
+        ChecksumTypes.crc32c: ChecksumHandler("append_crc32c", "verify_crc32c")
+    }
+
     def __init__(self, message: Message):
         self.message = message
 
@@ -261,7 +447,7 @@ class CppInterfaceGenerator:
         if type(field) == MessageFieldPlain:  # check without inheritance here (could e.g. be array otherwise)
             field = typing.cast(MessageFieldPlain, field)
             return "{} {}{{}};".format(self._get_plain_cpp_data_type(field.type), field.name)
-        elif type(field) == MessageFieldPlainArray:
+        elif type(field) == MessageFieldPlainArray or type(field) == MessageFieldEncodedArray:
             field = typing.cast(MessageFieldPlainArray, field)
             return "{} {}[{}]{{}};".format(self._get_plain_cpp_data_type(field.type), field.name, field.array_length)
 
@@ -280,21 +466,20 @@ class CppInterfaceGenerator:
         )
 
     @staticmethod
-    def _get_serialization_line_plainarray(field_type: str, object_name: str, byte_index: int, num_elements: int):
+    def _get_serialization_line_plainarray(field_type: str, object_name: str, byte_index: int, parallel: bool):
         """ Get the C++ serialization line of a plain array field """
         if field_type not in CppInterfaceGenerator.DATA_TYPE_LOOKUP:
             logging.error("Serialization for type {} is unknown".format(field_type))
             sys.exit(1)
 
-        return "microbuf::insert_bytes<{}>(bytes, microbuf::gen_multiple<{}>({}, microbuf::{}));".format(
-            byte_index, num_elements, object_name, CppInterfaceGenerator.DATA_TYPE_LOOKUP[field_type].serialize_fun
+        if parallel:
+            return "microbuf::insert_multiple_parallel<{}>(bytes, {}, microbuf::{}, executor);".format(
+                byte_index, object_name, CppInterfaceGenerator.DATA_TYPE_LOOKUP[field_type].serialize_fun
+            )
+        return "microbuf::insert_multiple<{}>(bytes, {}, microbuf::{});".format(
+            byte_index, object_name, CppInterfaceGenerator.DATA_TYPE_LOOKUP[field_type].serialize_fun
         )
 
-    def _gen_array_serialization_line(self):
-        return "microbuf::insert_bytes<0>(bytes, microbuf::{}({}));\n".format(
-            CppInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].serialization_fun,
-            self.message.get_num_of_plain_fields())
-
     @staticmethod
     def _gen_return_on_error():
         return "if(!worked) { return false; }"
@@ -302,77 +487,493 @@ class CppInterfaceGenerator:
     def _gen_struct(self, result):
         s4 = "    "  # spaces
         result.append("struct {}_struct_t {{\n".format(self.message.name))
-        result.append(
-            "".join([s4, "static constexpr size_t data_size = {};\n\n".format(self.message.get_num_of_bytes())]))
+        if self.message.has_variable_size():
+            result.append("".join([s4, "// maximum and minimum size of serialized data\n"]))
+            result.append(
+                "".join([s4, "static constexpr size_t data_size = {};\n".format(self.message.get_num_of_bytes())]))
+            result.append("".join([s4, "static constexpr size_t min_data_size = {};\n\n".format(
+                self.message.get_min_num_of_bytes())]))
+        else:
+            result.append(
+                "".join([s4, "static constexpr size_t data_size = {};\n\n".format(self.message.get_num_of_bytes())]))
         for field in self.message.fields:
             result.append("".join([s4, self._get_definition_line(field), "\n"]))
+        self._gen_presence_accessors(result)
 
-        # add as_bytes() for serialization
+        # add to_bytes() and as_bytes() for serialization
         result.append("".join([s4, "\n"]))
-        result.append(
-            "".join([s4, "microbuf::array<uint8_t,{}> as_bytes() const {{\n".format(self.message.get_num_of_bytes())]))
-        result.append(
-            "".join([s4 * 2, "microbuf::array<uint8_t,{}> bytes {{}};\n".format(self.message.get_num_of_bytes())]))
-        result.append("".join([s4 * 2, self._gen_array_serialization_line()]))
-        byte_index = 0 + ArrayTypes.storage_size[self.message.get_main_array_type()]
+        if self.message.has_variable_size():
+            result.append("".join([s4, "// Returns the number of bytes used (at most data_size)\n"]))
+        result.append("".join([s4, "size_t to_bytes(microbuf::array<uint8_t,data_size>& bytes) const {\n"]))
+        self._gen_serialization_lines(result)
+        result.append("".join([s4, "}\n"]))
+
+        if not self.message.has_variable_size():
+            result.append("".join([s4, "\n"]))
+            result.append("".join([s4, "microbuf::array<uint8_t,data_size> as_bytes() const {\n"]))
+            result.append("".join([s4 * 2, "microbuf::array<uint8_t,data_size> bytes {};\n"]))
+            result.append("".join([s4 * 2, "to_bytes(bytes);\n"]))
+            result.append("".join([s4 * 2, "return bytes;\n"]))
+            result.append("".join([s4, "}\n"]))
+
+        # add from_bytes() for deserialization - in place from any buffer and from microbuf::array
+        result.append("".join([s4, "\n"]))
+        if self.message.has_variable_size():
+            result.append("".join([s4, "// Deserialize a message with length bytes\n"]))
+            result.append("".join([s4, "bool from_bytes(const uint8_t* bytes, const size_t length) {\n"]))
+            result.append("".join([s4 * 2, "if(length < min_data_size || length > data_size) { return false; }\n"]))
+        else:
+            result.append("".join([s4, "// Deserialize from the first data_size of length bytes\n"]))
+            result.append("".join([s4, "bool from_bytes(const uint8_t* bytes, const size_t length) {\n"]))
+            result.append("".join([s4 * 2, "if(length < data_size) { return false; }\n"]))
+        self._gen_deserialization_lines(result)
+        result.append("".join([s4, "}\n"]))
+
+        result.append("".join([s4, "\n"]))
+        if self.message.has_variable_size():
+            result.append("".join([s4, "bool from_bytes(const microbuf::array<uint8_t,data_size>& bytes, "
+                                       "const size_t length) {\n"]))
+            result.append("".join([s4 * 2, "return from_bytes(bytes.begin(), length);\n"]))
+        else:
+            result.append("".join([s4, "bool from_bytes(const microbuf::array<uint8_t,data_size>& bytes) {\n"]))
+            result.append("".join([s4 * 2, "return from_bytes(bytes.begin(), bytes.size());\n"]))
+        result.append("".join([s4, "}\n"]))
+
+        if self.message.parallel:
+            self._gen_parallel_functions(result)
+        self._gen_push_parser(result)
+        self._gen_extractors(result)
+        if self.message.native_format:
+            self._gen_native_functions(result)
+
+        result.append("".join(["};\n\n"]))
+
+        if self.message.native_format:
+            self._gen_native_layout_checks(result)
+
+    def _gen_presence_accessors(self, result):
+        """ Add the presence bitmap and has_*()/set_has_*() for all optional fields """
+        presence_type = self.message.get_presence_type()
+        if presence_type is None:
+            return
+
+        s4 = "    "  # spaces
+        cpp_type = self._get_plain_cpp_data_type(presence_type)
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "// bit i is set if the i-th optional field is present (only those are sent)\n"]))
+        result.append("".join([s4, "{} {}{{}};\n".format(cpp_type, Message.PRESENCE_FIELD_NAME)]))
+        for bit, field in enumerate(self.message.get_optional_fields()):
+            mask = self._get_presence_mask_literal(1 << bit)
+            result.append("".join([s4, "bool has_{}() const {{ return ({} & {}) != 0; }}\n".format(
+                field.name, Message.PRESENCE_FIELD_NAME, mask)]))
+            result.append("".join([s4, "void set_has_{}(const bool value = true) {{\n".format(field.name)]))
+            result.append("".join([s4 * 2, "{presence} = static_cast<{cpp_type}>(value ? ({presence} | {mask}) : "
+                                            "({presence} & ~{mask}));\n".format(presence=Message.PRESENCE_FIELD_NAME,
+                                                                               cpp_type=cpp_type, mask=mask)]))
+            result.append("".join([s4, "}\n"]))
+
+    def _get_presence_mask_literal(self, mask: int):
+        suffix = "ULL" if self.message.get_presence_type() == PlainTypes.uint64 else "U"
+        return "0x{:x}{}".format(mask, suffix)
+
+    def _gen_main_array_length(self):
+        """ Length of the main array - depends on the presence of optional fields """
+        array_type = self.message.get_main_array_type()
+        num_plain_fields = self.message.get_num_of_plain_fields()
+        if self.message.get_presence_type() is None:
+            return str(num_plain_fields)
+
+        terms = []
+        for field in self.message.get_optional_fields():
+            num_plain_fields -= field.get_num_of_plain_fields()
+            terms.append("(has_{}() ? {} : 0)".format(field.name, field.get_num_of_plain_fields()))
+        length_type = {ArrayTypes.fixarray: "uint8_t", ArrayTypes.array16: "uint16_t",
+                       ArrayTypes.array32: "uint32_t"}[array_type]
+        return "static_cast<{}>({} + {})".format(length_type, num_plain_fields, " + ".join(terms))
+
+    def _get_fixed_start_index(self):
+        """ Index of the first field (behind the main array and presence bitmap) """
+        byte_index = ArrayTypes.storage_size[self.message.get_main_array_type()]
+        if self.message.get_presence_type() is not None:
+            byte_index += PlainTypes.storage_size[self.message.get_presence_type()]
+        return byte_index
+
+    def _gen_serialization_lines(self, result, parallel: bool = False):
+        """ Body of to_bytes() - large arrays and the CRC are handled by an executor if parallel """
+        s4 = "    "  # spaces
+        result.append("".join([s4 * 2, "microbuf::insert_bytes<0>(bytes, microbuf::{}({}));\n".format(
+            CppInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].serialization_fun,
+            self._gen_main_array_length())]))
+        presence_type = self.message.get_presence_type()
+        if presence_type is not None:
+            result.append("".join([s4 * 2, "microbuf::insert_bytes<{}>(bytes, microbuf::{}(static_cast<{}>({} & {})));"
+                                            "\n".format(
+                ArrayTypes.storage_size[self.message.get_main_array_type()],
+                CppInterfaceGenerator.DATA_TYPE_LOOKUP[presence_type].serialize_fun,
+                self._get_plain_cpp_data_type(presence_type), Message.PRESENCE_FIELD_NAME,
+                self._get_presence_mask_literal((1 << len(self.message.get_optional_fields())) - 1))]))
+
+        # fields have a static offset until the first field with variable size - then the offset is kept in length
+        byte_index = self._get_fixed_start_index()
         for field in self.message.fields:
+            if byte_index is not None and field.has_variable_size():
+                result.append("".join([s4 * 2, "size_t length = {};\n".format(byte_index)]))
+                byte_index = None
+
+            indent = s4 * 2
+            if field.optional:
+                result.append("".join([indent, "if(has_{}()) {{\n".format(field.name)]))
+                indent = s4 * 3
+
             if type(field) == MessageFieldPlain:
                 field = typing.cast(MessageFieldPlain, field)
-                result.append(
-                    "".join([s4 * 2, self._get_serialization_line_plain(field.type, field.name, byte_index) + "\n"]))
-                byte_index = byte_index + PlainTypes.storage_size[field.type]
+                if byte_index is not None:
+                    line = self._get_serialization_line_plain(field.type, field.name, byte_index)
+                    byte_index = byte_index + PlainTypes.storage_size[field.type]
+                else:
+                    line = "length = microbuf::insert_bytes(bytes, length, microbuf::{}({}));".format(
+                        CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].serialize_fun, field.name)
             elif type(field) == MessageFieldPlainArray:
                 field = typing.cast(MessageFieldPlainArray, field)
-                result.append("".join([s4 * 2,
-                                       self._get_serialization_line_plainarray(field.type, field.name, byte_index,
-                                                                               field.array_length) + "\n"]))
-                byte_index = byte_index + PlainTypes.storage_size[field.type] * field.array_length
+                if byte_index is not None:
+                    line = self._get_serialization_line_plainarray(field.type, field.name, byte_index, parallel)
+                    byte_index = byte_index + PlainTypes.storage_size[field.type] * field.array_length
+                else:
+                    line = "length = microbuf::insert_multiple(bytes, length, {}, microbuf::{});".format(
+                        field.name, CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].serialize_fun)
+            elif type(field) == MessageFieldEncodedArray:
+                field = typing.cast(MessageFieldEncodedArray, field)
+                line = "length = microbuf::gen_{}(bytes, length, {});".format(field.encoding, field.name)
             else:
                 logging.error("Unknown field object {}".format(field))
                 sys.exit(1)
 
-        if self.message.append_checksum:
-            result.append("".join([s4 * 2, "microbuf::append_crc(bytes);\n"]))
+            result.append("".join([indent, line, "\n"]))
+            if field.optional:
+                result.append("".join([s4 * 2, "}\n"]))
 
-        result.append("".join([s4 * 2, "return bytes;\n"]))
-        result.append("".join([s4, "}\n"]))
-
-        # add from_bytes() for deserialization
-        result.append("".join([s4, "\n"]))
-        result.append("".join([s4, "bool from_bytes(const microbuf::array<uint8_t,{}>& bytes) {{\n".format(
-            self.message.get_num_of_bytes())]))
-        result.append("".join([s4 * 2, "bool worked = microbuf::{}<0>(bytes, {});\n".format(
-            CppInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].deserialization_fun,
-            self.message.get_num_of_plain_fields())]))
+        if self.message.has_variable_size():
+            if self.message.append_checksum:
+                result.append("".join([s4 * 2, "length = microbuf::{}(bytes, length);\n".format(
+                    CppInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].serialization_fun)]))
+            result.append("".join([s4 * 2, "return length;\n"]))
+        else:
+            # CRC-32C is not split into chunks - with hardware support it is much faster than encoding anyway
+            if self.message.append_checksum and parallel and self.message.checksum == ChecksumTypes.crc16:
+                result.append("".join([s4 * 2, "microbuf::append_crc_parallel(bytes, executor);\n"]))
+            elif self.message.append_checksum:
+                result.append("".join([s4 * 2, "microbuf::{}(bytes);\n".format(
+                    CppInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].serialization_fun)]))
+            result.append("".join([s4 * 2, "return data_size;\n"]))
+
+    def _gen_deserialization_lines(self, result, parallel: bool = False):
+        """ Body of from_bytes() - large arrays and the CRC are handled by an executor if parallel """
+        s4 = "    "  # spaces
+        # fixed-size messages are only read within data_size (known at compile-time) after checking length
+        length = "length" if self.message.has_variable_size() else "data_size"
+        check_array_line = "microbuf::{}<0>(bytes, {}, {})".format(
+            CppInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].deserialization_fun, length,
+            self._gen_main_array_length())
+        presence_type = self.message.get_presence_type()
+        if presence_type is None:
+            result.append("".join([s4 * 2, "bool worked = {};\n".format(check_array_line)]))
+        else:
+            # the presence bitmap is needed to check the length of the main array
+            result.append("".join([s4 * 2, "bool worked = microbuf::{}<{}>(bytes, {}, {});\n".format(
+                CppInterfaceGenerator.DATA_TYPE_LOOKUP[presence_type].deserialize_fun,
+                ArrayTypes.storage_size[self.message.get_main_array_type()], length, Message.PRESENCE_FIELD_NAME)]))
+            result.append("".join([s4 * 2, self._gen_return_on_error(), "\n"]))
+            num_bits = 8 * PlainTypes.native_size[presence_type]
+            unknown_bits = ((1 << num_bits) - 1) & ~((1 << len(self.message.get_optional_fields())) - 1)
+            if unknown_bits != 0:
+                check_array_line = "({} & {}) == 0 && {}".format(Message.PRESENCE_FIELD_NAME,
+                                                                 self._get_presence_mask_literal(unknown_bits),
+                                                                 check_array_line)
+            result.append("".join([s4 * 2, "worked = {};\n".format(check_array_line)]))
         result.append("".join([s4 * 2, self._gen_return_on_error(), "\n"]))
 
-        byte_index = 0 + ArrayTypes.storage_size[self.message.get_main_array_type()]
+        # fields have a static offset until the first field with variable size - then the offset is kept in index
+        byte_index = self._get_fixed_start_index()
         for field in self.message.fields:
+            if byte_index is not None and field.has_variable_size():
+                result.append("".join([s4 * 2, "size_t index = {};\n".format(byte_index)]))
+                byte_index = None
+
+            indent = s4 * 2
+            if field.optional:
+                result.append("".join([indent, "if(has_{}()) {{\n".format(field.name)]))
+                indent = s4 * 3
+
             if type(field) == MessageFieldPlain:
                 field = typing.cast(MessageFieldPlain, field)
-                result.append("".join([s4 * 2, "worked = microbuf::{}<{}>(bytes, {});\n".format(
-                    CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].deserialize_fun, byte_index, field.name)]))
-                result.append("".join([s4 * 2, self._gen_return_on_error(), "\n"]))
-                byte_index = byte_index + PlainTypes.storage_size[field.type]
+                if byte_index is not None:
+                    line = "worked = microbuf::{}<{}>(bytes, {}, {});".format(
+                        CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].deserialize_fun, byte_index, length,
+                        field.name)
+                    byte_index = byte_index + PlainTypes.storage_size[field.type]
+                else:
+                    line = "worked = microbuf::parse_plain_at(bytes, length, index, {});".format(field.name)
             elif type(field) == MessageFieldPlainArray:
                 field = typing.cast(MessageFieldPlainArray, field)
-                result.append(
-                    "".join([s4 * 2, "worked = microbuf::parse_multiple<{},{}>(bytes, {}, microbuf::{}<0>);\n".format(
-                        field.array_length, byte_index, field.name,
-                        CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].deserialize_fun)]))
-                result.append("".join([s4 * 2, self._gen_return_on_error(), "\n"]))
-                byte_index = byte_index + PlainTypes.storage_size[field.type] * field.array_length
+                if byte_index is not None and parallel:
+                    line = "worked = microbuf::parse_multiple_parallel<{},{}>(bytes, {}, {}, microbuf::{}<0>, " \
+                           "executor);".format(field.array_length, byte_index, length, field.name,
+                                               CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].deserialize_fun)
+                    byte_index = byte_index + PlainTypes.storage_size[field.type] * field.array_length
+                elif byte_index is not None:
+                    line = "worked = microbuf::parse_multiple<{},{}>(bytes, {}, {}, microbuf::{}<0>);".format(
+                        field.array_length, byte_index, length, field.name,
+                        CppInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].deserialize_fun)
+                    byte_index = byte_index + PlainTypes.storage_size[field.type] * field.array_length
+                else:
+                    line = "worked = microbuf::parse_multiple_at(bytes, length, index, {});".format(field.name)
+            elif type(field) == MessageFieldEncodedArray:
+                field = typing.cast(MessageFieldEncodedArray, field)
+                line = "worked = microbuf::parse_{}(bytes, length, index, {});".format(field.encoding, field.name)
             else:
                 logging.error("Unknown field object {}".format(field))
                 sys.exit(1)
 
-        if self.message.append_checksum:
-            result.append("".join([s4 * 2, "worked = microbuf::verify_crc(bytes);\n"]))
+            result.append("".join([indent, line, "\n"]))
+            result.append("".join([indent, self._gen_return_on_error(), "\n"]))
+            if field.optional:
+                result.append("".join([s4 * 2, "}\n"]))
+
+        if self.message.has_variable_size():
+            if self.message.append_checksum:
+                result.append("".join([s4 * 2, "worked = index+{} == length && microbuf::{}(bytes, length);\n".format(
+                    PlainTypes.storage_size[self.message.get_checksum_value_type()],
+                    CppInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].deserialization_fun)]))
+            else:
+                result.append("".join([s4 * 2, "worked = index == length;\n"]))
+        elif self.message.append_checksum and parallel and self.message.checksum == ChecksumTypes.crc16:
+            result.append("".join([s4 * 2, "worked = microbuf::verify_crc_parallel(bytes, data_size, executor);\n"]))
+        elif self.message.append_checksum:
+            result.append("".join([s4 * 2, "worked = microbuf::{}(bytes, data_size);\n".format(
+                CppInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].deserialization_fun)]))
 
         result.append("".join([s4 * 2, "return worked;\n"]))
+
+    def _gen_parallel_functions(self, result):
+        """ Add to_bytes()/from_bytes() which split large arrays and the CRC into chunks for an executor """
+        s4 = "    "  # spaces
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "// Parallel versions: large array fields and the CRC are split into chunks which "
+                                   "are run by executor\n"]))
+        result.append("".join([s4, "// (e.g. microbuf::thread_pool from microbuf_parallel.h) - same bytes as the "
+                                   "serial versions\n"]))
+        result.append("".join([s4, "template<class Executor>\n"]))
+        result.append("".join([s4, "size_t to_bytes(microbuf::array<uint8_t,data_size>& bytes, Executor& executor) "
+                                   "const {\n"]))
+        self._gen_serialization_lines(result, parallel=True)
         result.append("".join([s4, "}\n"]))
 
-        result.append("".join(["};\n\n"]))
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "template<class Executor>\n"]))
+        result.append("".join([s4, "bool from_bytes(const uint8_t* bytes, const size_t length, Executor& executor) "
+                                   "{\n"]))
+        result.append("".join([s4 * 2, "if(length < data_size) { return false; }\n"]))
+        self._gen_deserialization_lines(result, parallel=True)
+        result.append("".join([s4, "}\n"]))
+
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "template<class Executor>\n"]))
+        result.append("".join([s4, "bool from_bytes(const microbuf::array<uint8_t,data_size>& bytes, "
+                                   "Executor& executor) {\n"]))
+        result.append("".join([s4 * 2, "return from_bytes(bytes.begin(), bytes.size(), executor);\n"]))
+        result.append("".join([s4, "}\n"]))
+
+    def _gen_push_parser(self, result):
+        """ Add push_byte() which decodes the message byte by byte (only for messages with fixed size and CRC16) """
+        if self.message.has_variable_size() or \
+                (self.message.append_checksum and self.message.checksum != ChecksumTypes.crc16):
+            return
+
+        s4 = "    "  # spaces
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "// Deserialize byte by byte as the bytes arrive - each field is written as soon as "
+                                   "it is complete\n"]))
+        result.append("".join([s4, "// Returns push_result::done with the last byte of a valid message - reset() state "
+                                   "after done or failed\n"]))
+        result.append("".join([s4, "microbuf::push_result push_byte(microbuf::push_state& state, const uint8_t byte) "
+                                   "{\n"]))
+        result.append("".join([s4 * 2, "bool worked = false;\n"]))
+
+        # (end index, push call) of all parts of the message
+        byte_index = ArrayTypes.storage_size[self.message.get_main_array_type()]
+        parts = [(byte_index, "microbuf::push_header<0>(state, byte, microbuf::{}({}))".format(
+            CppInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].serialization_fun,
+            self.message.get_num_of_plain_fields()))]
+        for field in self.message.fields:
+            field = typing.cast(MessageFieldPlain, field)
+            if type(field) == MessageFieldPlainArray:
+                field = typing.cast(MessageFieldPlainArray, field)
+                call = "microbuf::push_multiple<{},{}>(state, byte, {})".format(byte_index, field.array_length,
+                                                                                field.name)
+            else:
+                call = "microbuf::push_plain<{}>(state, byte, {})".format(byte_index, field.name)
+            byte_index = byte_index + field.get_num_of_bytes()
+            parts.append((byte_index, call))
+        if self.message.append_checksum:
+            parts.append(("data_size", "microbuf::push_crc<{}>(state, byte)".format(byte_index)))
+
+        for i, (end_index, call) in enumerate(parts):
+            condition = "if(state.index < {}) {{\n".format(end_index)
+            result.append("".join([s4 * 2, condition if i == 0 else "}} else {}".format(condition)]))
+            result.append("".join([s4 * 3, "worked = {};\n".format(call)]))
+        result.append("".join([s4 * 2, "}\n"]))
+        result.append("".join([s4 * 2, "return microbuf::push_verdict(state, worked, data_size);\n"]))
+        result.append("".join([s4, "}\n"]))
+
+    def _get_struct_members(self):
+        """ Get (name, type, number of elements) of all data members of the struct in their order """
+        members = []
+        for field in self.message.fields:
+            field = typing.cast(MessageFieldPlain, field)
+            num_elements = field.array_length if isinstance(field, MessageFieldPlainArray) else 1
+            members.append((field.name, field.type, num_elements))
+        if self.message.get_presence_type() is not None:
+            members.append((Message.PRESENCE_FIELD_NAME, self.message.get_presence_type(), 1))
+        return members
+
+    def _get_native_layout(self):
+        """ Calculate offset of each struct member and total size of the struct with natural alignment """
+        offsets = []
+        offset = 0
+        max_alignment = 1
+        for _, member_type, num_elements in self._get_struct_members():
+            alignment = PlainTypes.native_size[member_type]
+            max_alignment = max(max_alignment, alignment)
+            offset = (offset + alignment - 1) // alignment * alignment
+            offsets.append(offset)
+            offset = offset + alignment * num_elements
+
+        struct_size = (offset + max_alignment - 1) // max_alignment * max_alignment
+        return offsets, struct_size
+
+    def _gen_native_functions(self, result):
+        """ Add functions for the native format (memory layout of the struct, see microbuf.h) """
+        s4 = "    "  # spaces
+        checksum = "microbuf::checksum_type::{}".format(self.message.checksum if self.message.append_checksum
+                                                         else "none")
+        crc_size = PlainTypes.native_size[self.message.get_checksum_value_type()] if self.message.append_checksum \
+            else 0
+        offsets, struct_size = self._get_native_layout()
+
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "// Native format: memory layout of this struct - only for hosts with the same "
+                                   "layout and Endianness\n"]))
+        result.append("".join([s4, "static constexpr uint32_t schema_hash = 0x{:08x}U;\n".format(
+            self.message.get_schema_hash())]))
+        result.append("".join([s4, "static constexpr size_t native_data_size = {};\n".format(
+            PlainTypes.native_size[PlainTypes.uint32] + struct_size + crc_size)]))
+
+        # padding is not copied - merge adjacent members to as few ranges as possible
+        ranges = []
+        for (_, member_type, num_elements), offset in zip(self._get_struct_members(), offsets):
+            size = PlainTypes.native_size[member_type] * num_elements
+            if ranges and ranges[-1][0] + ranges[-1][1] == offset:
+                ranges[-1][1] += size
+            else:
+                ranges.append([offset, size])
+
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "size_t to_native_bytes(microbuf::array<uint8_t,native_data_size>& bytes) "
+                                   "const {\n"]))
+        result.append("".join([s4 * 2, "static const microbuf::native_range ranges[] {{{}}};\n".format(
+            ", ".join("{{{}, {}}}".format(offset, size) for offset, size in ranges))]))
+        result.append("".join([s4 * 2, "return microbuf::to_native_bytes<{}>(*this, schema_hash, bytes, ranges, {});"
+                                       "\n".format(checksum, len(ranges))]))
+        result.append("".join([s4, "}\n"]))
+
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "microbuf::array<uint8_t,native_data_size> as_native_bytes() const {\n"]))
+        result.append("".join([s4 * 2, "microbuf::array<uint8_t,native_data_size> bytes {};\n"]))
+        result.append("".join([s4 * 2, "to_native_bytes(bytes);\n"]))
+        result.append("".join([s4 * 2, "return bytes;\n"]))
+        result.append("".join([s4, "}\n"]))
+
+        bools = ["{{{}, {}}}".format(offset, num_elements)
+                 for (_, member_type, num_elements), offset in zip(self._get_struct_members(), offsets)
+                 if member_type == PlainTypes.bool]
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "bool from_native_bytes(const uint8_t* bytes, const size_t length) {\n"]))
+        if bools:
+            result.append("".join([s4 * 2, "static const microbuf::native_bools bools[] {{{}}};\n".format(
+                ", ".join(bools))]))
+            bools_args = "bools, {}".format(len(bools))
+        else:
+            bools_args = "nullptr, 0"
+        result.append("".join([s4 * 2, "return microbuf::from_native_bytes<{}>(*this, schema_hash, bytes, length, "
+                                       "{});\n".format(checksum, bools_args)]))
+        result.append("".join([s4, "}\n"]))
+
+        result.append("".join([s4, "\n"]))
+        result.append("".join([s4, "bool from_native_bytes(const microbuf::array<uint8_t,native_data_size>& bytes) "
+                                   "{\n"]))
+        result.append("".join([s4 * 2, "return from_native_bytes(bytes.begin(), bytes.size());\n"]))
+        result.append("".join([s4, "}\n"]))
+
+    def _gen_native_layout_checks(self, result):
+        """ Make sure that the memory layout of the struct is the one the native format expects """
+        struct_name = "{}_struct_t".format(self.message.name)
+        message = "Memory layout of {} differs from native format".format(struct_name)
+        offsets, struct_size = self._get_native_layout()
+
+        result.append("// Memory layout for the native format\n")
+        result.append('static_assert(sizeof({}) == {}, "{}");\n'.format(struct_name, struct_size, message))
+        for (name, _, _), offset in zip(self._get_struct_members(), offsets):
+            result.append('static_assert(offsetof({}, {}) == {}, "{}");\n'.format(struct_name, name, offset,
+                                                                                 message))
+
+    def _gen_extractors(self, result):
+        """ Add extract_<field>() functions for columnar access to recorded messages """
+        s4 = "    "  # spaces
+        if self.message.append_checksum:
+            crc_param = ", bool check_crc = false"
+            crc_arg = "check_crc"
+        else:
+            crc_param = ""
+            crc_arg = "false"
+
+        if self.message.has_variable_size():
+            # messages cannot be stored at a fixed stride
+            return
+
+        byte_index = 0 + ArrayTypes.storage_size[self.message.get_main_array_type()]
+        for field in self.message.fields:
+            if type(field) != MessageFieldPlain and type(field) != MessageFieldPlainArray:
+                logging.error("Unknown field object {}".format(field))
+                sys.exit(1)
+            field = typing.cast(MessageFieldPlain, field)
+            cpp_type = self._get_plain_cpp_data_type(field.type)
+            bytes_per_elem = PlainTypes.storage_size[field.type]
+
+            result.append("".join([s4, "\n"]))
+            if type(field) == MessageFieldPlain:
+                result.append("".join([s4, "// Extract {} from num_frames messages stored back to back "
+                                           "(data_size bytes each)\n".format(field.name)]))
+                offset = str(byte_index)
+            else:
+                field = typing.cast(MessageFieldPlainArray, field)
+                result.append("".join([s4, "// Extract {}[element] from num_frames messages stored back to back "
+                                           "(data_size bytes each)\n".format(field.name)]))
+                result.append("".join([s4, "template<size_t element>\n"]))
+                offset = "{}+element*{}".format(byte_index, bytes_per_elem)
+
+            result.append("".join([s4, "static size_t extract_{}(const uint8_t* frames, size_t num_frames, {}* column"
+                                       "{}, bool* valid = nullptr) {{\n".format(field.name, cpp_type, crc_param)]))
+            if type(field) == MessageFieldPlainArray:
+                result.append("".join([s4 * 2, 'static_assert(element < {}, "element out of range");\n'.format(
+                    field.array_length)]))
+            template_args = "{}, data_size".format(offset)
+            if self.message.append_checksum and self.message.checksum != ChecksumTypes.crc16:
+                template_args += ", {}, microbuf::checksum_type::{}".format(cpp_type, self.message.checksum)
+            result.append("".join([s4 * 2, "return microbuf::extract_column<{}>(frames, num_frames, column, "
+                                           "{}, valid);\n".format(template_args, crc_arg)]))
+            result.append("".join([s4, "}\n"]))
+
+            byte_index = byte_index + field.get_num_of_bytes()
 
 
 class MatlabInterfaceGenerator:
@@ -393,6 +994,11 @@ class MatlabInterfaceGenerator:
         ArrayTypes.array32: ArrayTypeHandler("gen_array32", "check_array32")
     }
 
+    CHECKSUM_LOOKUP = {
+        ChecksumTypes.crc16: ChecksumHandler("microbuf.crc16_aug_ccitt", "microbuf.check_crc"),
+        ChecksumTypes.crc32c: ChecksumHandler("microbuf.crc32c", "microbuf.check_crc32c")
+    }
+
     def __init__(self, message: Message):
         self.message = message
 
@@ -404,7 +1010,7 @@ class MatlabInterfaceGenerator:
 
     @staticmethod
     def _get_initialization_line(field: MessageField):
-        if type(field) == MessageFieldPlain or type(field) == MessageFieldPlainArray:
+        if type(field) in (MessageFieldPlain, MessageFieldPlainArray, MessageFieldEncodedArray):
             field = typing.cast(typing.Union[MessageFieldPlain, MessageFieldPlainArray], field)
             if field.type not in MatlabInterfaceGenerator.DATA_TYPE_LOOKUP:
                 logging.error("Initialization for type {} is unknown".format(field.type))
@@ -413,7 +1019,7 @@ class MatlabInterfaceGenerator:
         if type(field) == MessageFieldPlain:
             return "{} = {}({});\n".format(field.name, MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].data_type,
                                            MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].init_value)
-        elif type(field) == MessageFieldPlainArray:
+        elif type(field) == MessageFieldPlainArray or type(field) == MessageFieldEncodedArray:
             return "{} = repmat({}({}), 1, {});\n".\
                                         format(field.name,
                                                MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[field.type].data_type,
@@ -449,7 +1055,12 @@ class MatlabInterfaceGenerator:
 
         return "".join(lines)
 
-    def _get_serialization_lines(self, field: MessageField, idx: int, lines: typing.List[str]):
+    def _get_serialization_lines(self, field: MessageField, idx: typing.Optional[int], lines: typing.List[str]):
+        if idx is None:
+            # offset is only known at runtime (behind optional fields)
+            self._get_runtime_serialization_lines(field, lines)
+            return None
+
         if type(field) == MessageFieldPlain:
             field = typing.cast(MessageFieldPlain, field)
             idx_start = idx
@@ -471,6 +1082,13 @@ class MatlabInterfaceGenerator:
                                                 line_indent, lines)
             lines.append("end\n\n")
 
+            idx += field.get_num_of_bytes()
+        elif type(field) == MessageFieldEncodedArray:
+            # MATLAB does not compress the data, so the size is always the maximum size
+            field = typing.cast(MessageFieldEncodedArray, field)
+            lines.append(f"bytes({idx}:{idx + field.get_num_of_bytes() - 1}) = "
+                         f"microbuf.gen_{field.encoding}_{field.type}({field.name});\n\n")
+
             idx += field.get_num_of_bytes()
         else:
             logging.error("Field type unknown: {}".format(field))
@@ -478,6 +1096,49 @@ class MatlabInterfaceGenerator:
 
         return idx
 
+    def _get_runtime_serialization_lines(self, field: MessageField, lines: typing.List[str]):
+        """ Serialize field at idx and move idx behind it """
+        indent = ""
+        if field.optional:
+            lines.append("if has_{}\n".format(field.name))
+            indent = "    "
+
+        field = typing.cast(MessageFieldPlain, field)
+        if type(field) == MessageFieldPlain:
+            bytes_per_elem = field.get_num_of_bytes()
+            self._get_plain_serialization_lines(field.type, field.name, "idx", f"idx+{bytes_per_elem-1}", indent,
+                                                lines)
+            lines.append(f"{indent}idx = idx + {bytes_per_elem};\n")
+        elif type(field) == MessageFieldPlainArray:
+            field = typing.cast(MessageFieldPlainArray, field)
+            bytes_per_elem = field.get_num_of_bytes() // field.get_num_of_plain_fields()
+            lines.append(f"{indent}for i=1:{field.array_length}\n")
+            self._get_plain_serialization_lines(field.type, f"{field.name}(i)", "idx", f"idx+{bytes_per_elem-1}",
+                                                indent + "    ", lines)
+            lines.append(f"{indent}    idx = idx + {bytes_per_elem};\n")
+            lines.append(f"{indent}end\n")
+        elif type(field) == MessageFieldEncodedArray:
+            field = typing.cast(MessageFieldEncodedArray, field)
+            lines.append(f"{indent}bytes(idx:idx+{field.get_num_of_bytes() - 1}) = "
+                         f"microbuf.gen_{field.encoding}_{field.type}({field.name});\n")
+            lines.append(f"{indent}idx = idx + {field.get_num_of_bytes()};\n")
+        else:
+            logging.error("Field type unknown: {}".format(field))
+            sys.exit(1)
+
+        if field.optional:
+            lines.append("end\n")
+        lines.append("\n")
+
+    def _gen_main_array_length(self):
+        """ Length of the main array - depends on the presence of optional fields """
+        num_plain_fields = self.message.get_num_of_plain_fields()
+        terms = []
+        for field in self.message.get_optional_fields():
+            num_plain_fields -= field.get_num_of_plain_fields()
+            terms.append("{}*has_{}".format(field.get_num_of_plain_fields(), field.name))
+        return " + ".join([str(num_plain_fields)] + terms)
+
     def _get_deserialization_lines(self, field: MessageField):
         lines = []
         if type(field) == MessageFieldPlain:
@@ -489,20 +1150,39 @@ class MatlabInterfaceGenerator:
             lines.append("".join([self._get_plain_deserialization_lines(field.type, "{}(i)".format(field.name),
                                                                         "    ")]))
             lines.append("".join(["end\n\n"]))
+        elif type(field) == MessageFieldEncodedArray:
+            field = typing.cast(MessageFieldEncodedArray, field)
+            lines.append("[idx, err, {}] = microbuf.parse_{}_{}(bytes, bytes_length, {}, idx);\n".format(
+                field.name, field.encoding, field.type, field.array_length))
+            lines.append("if err ;return; end\n\n")
         else:
             logging.error("Field type unknown: {}".format(field))
             sys.exit(1)
 
+        if field.optional:
+            # only parse if present
+            body = "".join(lines).strip("\n").split("\n")
+            return "if has_{}\n{}\nend\n\n".format(field.name, "\n".join("    " + line for line in body))
+
         return "".join(lines)
 
     def gen_serializer_content(self) -> str:
         result: typing.List[str] = []
         fun_name = f"serialize_{self.message.name}"
-        result.append(f"""function bytes = {fun_name}"""
-                      f"""({', '.join(f.name for f in self.message.fields)})""")
+        optional_fields = self.message.get_optional_fields()
+        presence_type = self.message.get_presence_type()
+        arguments = [f.name for f in self.message.fields] + ["has_{}".format(f.name) for f in optional_fields]
+        if presence_type is None:
+            result.append(f"""function bytes = {fun_name}({', '.join(arguments)})""")
+        else:
+            result.append(f"""function [bytes, bytes_length] = {fun_name}({', '.join(arguments)})""")
         result.append("\n")
         result.append(f"% {fun_name} Serialize microbuf message {self.message.name} (version {self.message.version})")
-        result.append("\n\n")
+        result.append("\n")
+        if presence_type is not None:
+            result.append("% Optional fields are only serialized if their has_* argument is true - only the first "
+                          "bytes_length bytes are used\n")
+        result.append("\n")
 
         # initialize result variable (bytes array)
         result.append(f"bytes = repmat(uint8(0), 1, {self.message.get_num_of_bytes()});\n\n")
@@ -513,21 +1193,45 @@ class MatlabInterfaceGenerator:
         result.append("bytes(1:{}) = microbuf.{}({});\n\n".format(
             1+array_storage_size-1,
             MatlabInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].serialization_fun,
-            self.message.get_num_of_plain_fields()
+            self._gen_main_array_length()
         ))
 
         idx += array_storage_size
 
-        # serialize all fields
+        # add presence bitmap
+        if presence_type is not None:
+            result.append("presence = {}(0);\n".format(MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[presence_type].data_type))
+            for bit, field in enumerate(optional_fields):
+                result.append("if has_{}\n    presence = bitset(presence, {});\nend\n".format(field.name, bit+1))
+            self._get_plain_serialization_lines(presence_type, "presence", str(idx),
+                                                str(idx + PlainTypes.storage_size[presence_type] - 1), "", result)
+            result.append("\n")
+            idx += PlainTypes.storage_size[presence_type]
+
+        # serialize all fields - the offset is only known at runtime after the first optional field
         for field in self.message.fields:
+            if idx is not None and field.optional:
+                result.append(f"idx = {idx};\n")
+                idx = None
             idx = self._get_serialization_lines(field, idx, result)
 
         # add crc
-        if self.message.append_checksum:
-            result.append(f"""bytes({idx}:{idx+PlainTypes.storage_size[PlainTypes.uint16]-1}) = """
-                          f"""{MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[PlainTypes.uint16].serialize_fun}"""
-                          f"""(microbuf.crc16_aug_ccitt(bytes, {idx-1}));\n\n""")
-            idx += PlainTypes.storage_size[PlainTypes.uint16]
+        crc_type = self.message.get_checksum_value_type()
+        crc_storage_size = PlainTypes.storage_size[crc_type]
+        crc_fun = MatlabInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].serialization_fun
+        if self.message.append_checksum and idx is None:
+            result.append(f"""bytes(idx:idx+{crc_storage_size-1}) = """
+                          f"""{MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[crc_type].serialize_fun}"""
+                          f"""({crc_fun}(bytes, idx-1));\n""")
+            result.append(f"idx = idx + {crc_storage_size};\n\n")
+        elif self.message.append_checksum:
+            result.append(f"""bytes({idx}:{idx+crc_storage_size-1}) = """
+                          f"""{MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[crc_type].serialize_fun}"""
+                          f"""({crc_fun}(bytes, {idx-1}));\n\n""")
+            idx += crc_storage_size
+
+        if presence_type is not None:
+            result.append("bytes_length = {} - 1;\n\n".format("idx" if idx is None else idx))
 
         result.append("end")
         return "".join(result)
@@ -535,8 +1239,11 @@ class MatlabInterfaceGenerator:
     def gen_deserializer_content(self):
         result = []  # type: typing.List[str]
 
+        optional_fields = self.message.get_optional_fields()
+        presence_type = self.message.get_presence_type()
+        outputs = [f.name for f in self.message.fields] + ["has_{}".format(f.name) for f in optional_fields]
         result.append("function [err, {}] = deserialize_{}(bytes, bytes_length)".format(
-            ", ".join(f.name for f in self.message.fields), self.message.name))
+            ", ".join(outputs), self.message.name))
         result.append("\n")
         result.append("% deserialize_{} Parse microbuf message {} (version {})\n\n".format(
                                 self.message.name, self.message.name, self.message.version))
@@ -544,26 +1251,153 @@ class MatlabInterfaceGenerator:
 
         for field in self.message.fields:
             result.append(self._get_initialization_line(field))
+        for field in optional_fields:
+            result.append("has_{} = false;\n".format(field.name))
 
         result.append("\n")
 
         # check length of bytes array
-        result.append("if bytes_length < {}\n    return\nend\n\n".format(self.message.get_num_of_bytes()))
-
-        result.append("idx = 1;\n\n")
+        result.append("if bytes_length < {}\n    return\nend\n\n".format(self.message.get_min_num_of_bytes()))
+
+        if presence_type is not None:
+            # presence bitmap is needed to check the length of the initial array
+            result.append("[idx, err, presence] = {}(bytes, bytes_length, {});\n".format(
+                MatlabInterfaceGenerator.DATA_TYPE_LOOKUP[presence_type].deserialize_fun,
+                1 + ArrayTypes.storage_size[self.message.get_main_array_type()]))
+            result.append("if err ;return; end\n")
+            result.append("if bitshift(presence, -{}) ~= 0\n    err = true; % unknown optional fields\n"
+                          "    return\nend\n".format(len(optional_fields)))
+            for bit, field in enumerate(optional_fields):
+                result.append("has_{} = bitget(presence, {}) == 1;\n".format(field.name, bit+1))
+            result.append("\n")
+
+            # check initial array
+            result.append("[~, err] = microbuf.{}(bytes, bytes_length, {}, 1);\n".format(
+                MatlabInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].deserialization_fun,
+                self._gen_main_array_length()))
+            result.append("if err ;return; end\n\n")
+        else:
+            result.append("idx = 1;\n\n")
 
-        # check initial array
-        result.append("[idx, err] = microbuf.{}(bytes, bytes_length, {}, idx);\n".format(
-                        MatlabInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].deserialization_fun,  # unchecked
-                        self.message.get_num_of_plain_fields()))
-        result.append("if err ;return; end\n\n")
+            # check initial array
+            result.append("[idx, err] = microbuf.{}(bytes, bytes_length, {}, idx);\n".format(
+                            MatlabInterfaceGenerator.ARRAY_LOOKUP[self.message.get_main_array_type()].deserialization_fun,  # unchecked
+                            self.message.get_num_of_plain_fields()))
+            result.append("if err ;return; end\n\n")
 
         for field in self.message.fields:
             result.append(self._get_deserialization_lines(field))
 
         if self.message.append_checksum:
-            result.append("[err] = microbuf.check_crc(bytes, bytes_length, idx);\n\n")
+            result.append("[err] = {}(bytes, bytes_length, idx);\n\n".format(
+                MatlabInterfaceGenerator.CHECKSUM_LOOKUP[self.message.checksum].deserialization_fun))
             # no "if err; return; end" needed here b/c we're at the end of the function already
 
         result.append("end")
         return "".join(result)
+
+
+class PythonInterfaceGenerator:
+    """
+    Generates a Python module with a NumPy structured dtype for decoding recorded messages (only for messages with
+    fixed size, which can be stored back to back) - needs python/microbuf_numpy.py
+    """
+    # NumPy type of the value behind the msgpack prefix (bool values are stored in the prefix itself)
+    DATA_TYPE_LOOKUP = {
+        PlainTypes.uint8: "u1",
+        PlainTypes.uint16: ">u2",
+        PlainTypes.uint32: ">u4",
+        PlainTypes.uint64: ">u8",
+        PlainTypes.float32: ">f4",
+        PlainTypes.float64: ">f8"
+    }
+
+    def __init__(self, message: Message):
+        self.message = message
+
+    def gen_module_filename(self):
+        return "{}.py".format(self.message.name)
+
+    def is_supported(self):
+        return not self.message.has_variable_size()
+
+    def _get_header_bytes(self):
+        """ Serialized msgpack array header of the message """
+        num_plain_fields = self.message.get_num_of_plain_fields()
+        array_type = self.message.get_main_array_type()
+        if array_type == ArrayTypes.fixarray:
+            return [0x90 | num_plain_fields]
+        elif array_type == ArrayTypes.array16:
+            return [0xdc] + list(num_plain_fields.to_bytes(2, "big"))
+        else:
+            return [0xdd] + list(num_plain_fields.to_bytes(4, "big"))
+
+    def _get_dtype_line(self, name: str, field_type: str, array_length: typing.Optional[int]):
+        if field_type == PlainTypes.bool:
+            element = '"u1"'
+        else:
+            element = '[("prefix", "u1"), ("value", "{}")]'.format(PythonInterfaceGenerator.DATA_TYPE_LOOKUP[field_type])
+        if array_length is None:
+            return '    ("{}", {}),\n'.format(name, element)
+        return '    ("{}", {}, ({},)),\n'.format(name, element, array_length)
+
+    def gen_module_content(self):
+        result = []  # type: typing.List[str]
+        result.append("# Microbuf Message: {}\n".format(self.message.name))
+        result.append("# Version {}\n".format(self.message.version))
+        result.append("# Decode recorded messages with NumPy - python/microbuf_numpy.py must be on the path\n")
+        result.append("import numpy as np\n")
+        result.append("import microbuf_numpy\n\n")
+        result.append("data_size = {}\n\n".format(self.message.get_num_of_bytes()))
+
+        header = self._get_header_bytes()
+        result.append("# One serialized message: msgpack prefix and Big Endian value of each element\n")
+        result.append("dtype = np.dtype([\n")
+        result.append('    ("_header", "u1", ({},)),\n'.format(len(header)))
+        for field in self.message.fields:
+            field = typing.cast(MessageFieldPlain, field)
+            array_length = field.array_length if isinstance(field, MessageFieldPlainArray) else None
+            result.append(self._get_dtype_line(field.name, field.type, array_length))
+        if self.message.append_checksum:
+            result.append(self._get_dtype_line("_checksum", self.message.get_checksum_value_type(), None))
+        result.append("])\n")
+        result.append("assert dtype.itemsize == data_size\n\n")
+
+        result.append("header = np.array([{}], dtype=np.uint8)\n\n".format(
+            ", ".join("0x{:02x}".format(byte) for byte in header)))
+
+        result.append("# (name, type) of all fields\n")
+        result.append("fields = [\n")
+        for field in self.message.fields:
+            result.append('    ("{}", "{}"),\n'.format(field.name, typing.cast(MessageFieldPlain, field).type))
+        result.append("]\n\n\n")
+
+        crc_param = ", check_crc=False" if self.message.append_checksum else ""
+        result.append("def decode(data{}):\n".format(crc_param))
+        result.append('    """\n')
+        result.append("    Decode all messages in data (bytes-like or uint8 array with messages of data_size bytes "
+                      "stored back to back)\n")
+        result.append("    Returns (columns, valid): dict of field name -> NumPy array in native byte order with one "
+                      "row per message,\n")
+        if self.message.append_checksum:
+            result.append("    and a bool array which is False for messages with a wrong header, prefix or "
+                          "(if check_crc) checksum\n")
+        else:
+            result.append("    and a bool array which is False for messages with a wrong header or prefix\n")
+        result.append('    """\n')
+        result.append("    frames = microbuf_numpy.frames_from_buffer(data, dtype)\n")
+        result.append("    valid = microbuf_numpy.check_header(frames, header)\n")
+        result.append("    columns = {}\n")
+        result.append("    for name, field_type in fields:\n")
+        result.append("        columns[name], field_valid = microbuf_numpy.decode_field(frames[name], field_type)\n")
+        result.append("        valid &= field_valid\n")
+        if self.message.append_checksum:
+            result.append("    if check_crc:\n")
+            result.append('        valid &= microbuf_numpy.check_crc(frames, "{}")\n'.format(self.message.checksum))
+        result.append("    return columns, valid\n\n\n")
+
+        crc_arg = ", check_crc" if self.message.append_checksum else ""
+        result.append("def decode_file(filename{}):\n".format(crc_param))
+        result.append('    """ Decode all messages in a recorded file - see decode() """\n')
+        result.append("    return decode(np.fromfile(filename, dtype=np.uint8){})\n".format(crc_arg))
+        return "".join(result)
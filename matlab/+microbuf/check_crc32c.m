@@ -0,0 +1,22 @@
+function [err] = check_crc32c(bytes, bytes_length, idx)
+%CHECK_CRC32C Check whether bytes contains the correct CRC-32C checksum
+%at the current position
+
+orig_idx = idx;
+
+% find expected CRC value
+[~, err, expected_crc] = microbuf.parse_uint32(bytes, bytes_length, idx);
+if err
+    return
+end
+
+err = true; % still need to verify checksum
+num_payload_bytes = orig_idx-1; % bytes_length could possibly be larger
+actual_crc = microbuf.crc32c(bytes, num_payload_bytes);
+
+if actual_crc == expected_crc
+    err = false;
+end
+
+end
+
@@ -0,0 +1,27 @@
+function bytes = gen_xor_delta_float32(values)
+%gen_xor_delta_float32 Convert float32/single array to a field with
+%@xor_delta encoding (msgpack bin). MATLAB does not compress the values
+%(mode 0), so the result always has the maximum size of the field.
+
+num_values = length(values);
+payload_length = 1 + 4*num_values;
+
+if payload_length <= 2^8-1
+    header = uint8([hex2dec('c4') payload_length]);
+elseif payload_length <= 2^16-1
+    header = [uint8(hex2dec('c5')) microbuf.uint_to_big_endian(uint16(payload_length))];
+else
+    header = [uint8(hex2dec('c6')) microbuf.uint_to_big_endian(uint32(payload_length))];
+end
+header_length = length(header);
+
+bytes = repmat(uint8(0), 1, header_length + payload_length);
+bytes(1:header_length) = header;
+bytes(header_length+1) = 0; % mode: raw values
+
+for i=1:num_values
+    idx = header_length + 2 + (i-1)*4;
+    bytes(idx:idx+3) = microbuf.uint_to_big_endian(typecast(single(values(i)), 'uint32'));
+end
+
+end
@@ -0,0 +1,118 @@
+function [idx, err, values] = parse_xor_delta_float32(bytes, bytes_length, num_values, idx)
+%PARSE_XOR_DELTA_FLOAT32 Parse num_values float32 values of a field with
+%@xor_delta encoding (msgpack bin) at the current position
+%   The payload starts with a mode byte: 0 for raw Big Endian values,
+%   1 for a Gorilla-style XOR-coded bit stream (compare encode_xor_delta
+%   in microbuf.h)
+
+err = true;
+values = repmat(single(0), 1, num_values);
+
+% the header type depends on the maximum payload length
+max_payload_length = 1 + 4*num_values;
+if max_payload_length <= 2^8-1
+    prefix = hex2dec('c4');
+    header_length = 2;
+elseif max_payload_length <= 2^16-1
+    prefix = hex2dec('c5');
+    header_length = 3;
+else
+    prefix = hex2dec('c6');
+    header_length = 5;
+end
+
+if bytes_length < idx+header_length-1 || bytes(idx) ~= prefix
+    return
+end
+
+if header_length == 2
+    payload_length = double(bytes(idx+1));
+else
+    payload_length = double(microbuf.from_big_endian(bytes(idx+1:idx+header_length-1)));
+end
+
+payload_idx = idx+header_length;
+if payload_length < 1 || payload_length > max_payload_length || bytes_length < payload_idx+payload_length-1
+    return
+end
+
+if bytes(payload_idx) == 0
+    % raw values
+    if payload_length ~= max_payload_length
+        return
+    end
+    for i=1:num_values
+        value_idx = payload_idx + 1 + (i-1)*4;
+        values(i) = typecast(microbuf.from_big_endian(bytes(value_idx:value_idx+3)), 'single');
+    end
+elseif bytes(payload_idx) == 1
+    % XOR-coded bit stream
+    start_idx = payload_idx+1;
+    num_bits = (payload_length-1)*8;
+    bit_pos = 0;
+
+    [bit_pos, ok, value] = read_bits(bytes, start_idx, num_bits, bit_pos, 32);
+    if ~ok ;return; end
+    values(1) = typecast(value, 'single');
+
+    window_leading = 0;
+    window_length = 0; % 0: no window yet
+    for i=2:num_values
+        [bit_pos, ok, control] = read_bits(bytes, start_idx, num_bits, bit_pos, 1);
+        if ~ok ;return; end
+        if control == 1
+            [bit_pos, ok, control] = read_bits(bytes, start_idx, num_bits, bit_pos, 1);
+            if ~ok ;return; end
+            if control == 1
+                % new window
+                [bit_pos, ok, leading] = read_bits(bytes, start_idx, num_bits, bit_pos, 5);
+                if ~ok ;return; end
+                [bit_pos, ok, len] = read_bits(bytes, start_idx, num_bits, bit_pos, 5);
+                if ~ok ;return; end
+                window_leading = double(leading);
+                window_length = double(len)+1;
+                if window_leading+window_length > 32
+                    return
+                end
+            elseif window_length == 0
+                return
+            end
+            [bit_pos, ok, meaningful] = read_bits(bytes, start_idx, num_bits, bit_pos, window_length);
+            if ~ok ;return; end
+            value = bitxor(value, bitshift(meaningful, 32-window_leading-window_length));
+        end
+        values(i) = typecast(value, 'single');
+    end
+
+    % all bytes must have been used (only padding bits may be left)
+    if num_bits - bit_pos >= 8
+        return
+    end
+else
+    return
+end
+
+idx = payload_idx+payload_length;
+err = false;
+
+end
+
+function [bit_pos, ok, value] = read_bits(bytes, start_idx, num_bits, bit_pos, n)
+% Read n bits (MSB first) after the first bit_pos bits of the bit stream at start_idx
+
+ok = false;
+value = uint32(0);
+
+if bit_pos+n > num_bits
+    return
+end
+
+for k=1:n
+    byte = bytes(start_idx + floor(bit_pos/8));
+    bit = bitand(bitshift(byte, -(7-mod(bit_pos, 8))), 1);
+    value = bitor(bitshift(value, 1), uint32(bit));
+    bit_pos = bit_pos+1;
+end
+ok = true;
+
+end
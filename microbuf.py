@@ -14,6 +14,11 @@ def parse_cmdline_arguments():
     parser.add_argument('mmsg_file', action="store", nargs="+", help="*.mmsg interface description files to use")
     parser.add_argument('--out', '-o', action='store', help='output folder to use (default: output/)',
                         default="output/")
+    parser.add_argument('--native', action='store_true',
+                        help='additionally generate native format functions for C++ (like native_format: yes)')
+    parser.add_argument('--parallel', action='store_true',
+                        help='additionally generate parallel C++ functions for messages with static offsets '
+                             '(like parallel: yes)')
     parser.add_argument('--verbose', '-v', action='count', help='increase verbosity level (maximum: -vv)', default=0)
 
     args = parser.parse_args()
@@ -29,7 +34,7 @@ def parse_cmdline_arguments():
     return args
 
 
-def parse_mmsg_file(mmsg_file: str) -> Message:
+def parse_mmsg_file(mmsg_file: str, native_format: bool = False, parallel: bool = False) -> Message:
     if not mmsg_file.endswith(".mmsg"):
         logging.error("Filename {} does not end with .mmsg".format(mmsg_file))
         sys.exit(1)
@@ -70,28 +75,63 @@ def parse_mmsg_file(mmsg_file: str) -> Message:
     else:
         append_checksum = False
 
-    message = Message(mmsg_name, mmsg_version, append_checksum=append_checksum)
+    # checksum: crc16/crc32c selects the type and implies append_checksum
+    checksum = ChecksumTypes.crc16
+    if "checksum" in mmsg_yaml:
+        if mmsg_yaml["checksum"] not in ChecksumTypes.all:
+            logging.error("Unknown checksum '{}' in {} (known: {})".format(mmsg_yaml["checksum"], mmsg_file,
+                                                                          ", ".join(ChecksumTypes.all)))
+            sys.exit(1)
+        checksum = mmsg_yaml["checksum"]
+        append_checksum = True
+
+    if "native_format" in mmsg_yaml and mmsg_yaml["native_format"] is True:
+        native_format = True
+
+    parallel_requested = "parallel" in mmsg_yaml and mmsg_yaml["parallel"] is True
+
+    message = Message(mmsg_name, mmsg_version, append_checksum=append_checksum, native_format=native_format,
+                      parallel=parallel or parallel_requested, checksum=checksum)
 
     for field_name, field_type in mmsg_yaml["content"].items():
-        if field_type.isalnum():
-            # plain data type
-            field = MessageFieldPlain(field_name, field_type)
+        # plain data type or plain array type, possibly optional (trailing ?) and with an encoding
+        match = re.fullmatch(r"([a-z0-9]+)(?:\[([0-9]+)\])?(\?)?(?:\s+@([a-z_]+))?", str(field_type))
+        if not match or (match.group(4) and not match.group(2)):
+            logging.error("Field '{}' has invalid type '{}'".format(field_name, field_type))
+            sys.exit(1)
+
+        optional = match.group(3) is not None
+        if match.group(4):
+            field = MessageFieldEncodedArray(field_name, field_type=match.group(1), array_length=int(match.group(2)),
+                                             encoding=match.group(4), optional=optional)
+        elif match.group(2):
+            field = MessageFieldPlainArray(field_name, field_type=match.group(1), array_length=int(match.group(2)),
+                                           optional=optional)
         else:
-            # check if plain array type
-            match = re.fullmatch(r"([a-z0-9]+)\[([0-9]+)\]", field_type)
-            if match:
-                field = MessageFieldPlainArray(field_name, field_type=match.group(1),
-                                               array_length=int(match.group(2)))
-            else:
-                logging.error("Field '{}' has invalid type '{}'".format(field_name, field_type))
-                sys.exit(1)
+            field = MessageFieldPlain(field_name, match.group(1), optional=optional)
 
         message.add_field(field)
 
+    # parallel functions split fields at their static offsets
+    if message.parallel and message.has_variable_size():
+        if parallel_requested:
+            logging.error("{} has fields with variable size (optional or encoded) and cannot be parallel".format(
+                mmsg_file))
+            sys.exit(1)
+        logging.warning("Not generating parallel functions for {} (fields with variable size)".format(mmsg_file))
+        message.parallel = False
+
     return message
 
 
 def create_interface(args, message: Message):
+    if message.has_variable_size():
+        print("--- Serialized size: {} to {} bytes".format(message.get_min_num_of_bytes(), message.get_num_of_bytes()))
+    else:
+        print("--- Serialized size: {} bytes".format(message.get_num_of_bytes()))
+    if message.native_format:
+        print("--- Native format enabled for C++ (schema hash 0x{:08x})".format(message.get_schema_hash()))
+
     print("-- Creating C++ interface for message {}...".format(message.name))
     cpp_enc = CppInterfaceGenerator(message)
     cpp_file_path = os.path.join(args.out, cpp_enc.gen_header_filename())
@@ -111,6 +151,16 @@ def create_interface(args, message: Message):
     with open(mat_serializer_file_path, "w") as outfile:
         outfile.write(mat_if.gen_serializer_content())
 
+    py_if = PythonInterfaceGenerator(message)
+    if py_if.is_supported():
+        print("-- Creating Python (NumPy) interface for message {}...".format(message.name))
+        py_file_path = os.path.join(args.out, py_if.gen_module_filename())
+        print("--- Saving as {}".format(py_file_path))
+        with open(py_file_path, "w") as outfile:
+            outfile.write(py_if.gen_module_content())
+    else:
+        print("-- Skipping Python (NumPy) interface for message {} (variable size)".format(message.name))
+
 
 def main():
     args = parse_cmdline_arguments()
@@ -123,7 +173,7 @@ def main():
 
     for mmsg_file in args.mmsg_file:
         print("-- Trying to read interface description file {}...".format(mmsg_file))
-        message = parse_mmsg_file(mmsg_file)
+        message = parse_mmsg_file(mmsg_file, args.native, args.parallel)
         create_interface(args, message)
 
 
@@ -0,0 +1,106 @@
+# -*- coding: utf-8 -*-
+"""
+Support functions for the NumPy modules which microbuf.py generates for messages with a fixed size
+
+A generated module (e.g. output/SensorData.py) contains a structured dtype which matches one serialized message byte
+by byte (msgpack prefixes and Big Endian values) and decode() which turns recorded messages stored back to back into
+one column per field. All checks work on all messages at once.
+"""
+import numpy as np
+
+# msgpack prefix of each plain type - bool values are the prefix itself
+PREFIXES = {
+    "uint8": 0xcc,
+    "uint16": 0xcd,
+    "uint32": 0xce,
+    "uint64": 0xcf,
+    "float32": 0xca,
+    "float64": 0xcb
+}
+FALSE = 0xc2
+TRUE = 0xc3
+
+
+def frames_from_buffer(data, dtype: np.dtype) -> np.ndarray:
+    """ View data (bytes-like or uint8 array) as array of messages without copying - an incomplete rest is ignored """
+    num_frames = len(data) // dtype.itemsize
+    return np.frombuffer(data, dtype=dtype, count=num_frames)
+
+
+def raw_bytes(frames: np.ndarray) -> np.ndarray:
+    """ Bytes of frames as 2D uint8 array with one row per message """
+    return frames.view(np.uint8).reshape(len(frames), frames.dtype.itemsize)
+
+
+def _all_per_frame(valid: np.ndarray) -> np.ndarray:
+    # reduce checks of array fields to one value per message
+    return np.all(valid, axis=tuple(range(1, valid.ndim)))
+
+
+def check_header(frames: np.ndarray, header: np.ndarray) -> np.ndarray:
+    """ Check the msgpack array header of each message """
+    return _all_per_frame(frames["_header"] == header)
+
+
+def decode_field(field: np.ndarray, field_type: str):
+    """ Check the prefixes of a field and get its values in native byte order - returns (column, valid) """
+    if field_type == "bool":
+        valid = (field == FALSE) | (field == TRUE)
+        column = field == TRUE
+    else:
+        valid = field["prefix"] == PREFIXES[field_type]
+        values = field["value"]
+        column = values.astype(values.dtype.newbyteorder("="))
+    return column, _all_per_frame(valid)
+
+
+def _crc16_table() -> np.ndarray:
+    table = np.zeros(256, dtype=np.uint16)
+    for byte in range(256):
+        crc = byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table[byte] = crc & 0xffff
+    return table
+
+
+def _crc32c_table() -> np.ndarray:
+    table = np.zeros(256, dtype=np.uint32)
+    for byte in range(256):
+        crc = byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x82f63b78 if crc & 1 else crc >> 1
+        table[byte] = crc
+    return table
+
+
+_CRC16_TABLE = _crc16_table()
+_CRC32C_TABLE = _crc32c_table()
+
+
+def crc16_aug_ccitt(raw: np.ndarray) -> np.ndarray:
+    """ CRC16/AUG-CCITT of each row of raw (2D uint8 array) - one step per column for all rows """
+    columns = np.ascontiguousarray(raw.T)
+    crc = np.full(raw.shape[0], 0x1d0f, dtype=np.uint16)
+    for column in columns:
+        crc = (crc << 8) ^ _CRC16_TABLE[(crc >> 8) ^ column]
+    return crc
+
+
+def crc32c(raw: np.ndarray) -> np.ndarray:
+    """ CRC-32C of each row of raw (2D uint8 array) - one step per column for all rows """
+    columns = np.ascontiguousarray(raw.T)
+    crc = np.full(raw.shape[0], 0xffffffff, dtype=np.uint32)
+    for column in columns:
+        crc = (crc >> 8) ^ _CRC32C_TABLE[(crc ^ column) & 0xff]
+    return crc ^ np.uint32(0xffffffff)
+
+
+def check_crc(frames: np.ndarray, checksum: str) -> np.ndarray:
+    """ Check prefix and value of the checksum ("crc16" or "crc32c") at the end of each message """
+    expected = frames["_checksum"]
+    size = expected.dtype.itemsize
+    payload = raw_bytes(frames)[:, :-size]
+    if checksum == "crc32c":
+        return (expected["prefix"] == PREFIXES["uint32"]) & (crc32c(payload) == expected["value"])
+    return (expected["prefix"] == PREFIXES["uint16"]) & (crc16_aug_ccitt(payload) == expected["value"])
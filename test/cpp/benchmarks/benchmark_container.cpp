@@ -0,0 +1,107 @@
+// Throughput benchmark: small messages over UDP loopback, one datagram per message vs. coalesced into containers
+
+#include "microbuf_container.h"
+#include "TestMessage3.h" // test/messages/TestMessage3.mmsg must have been converted before trying to compile this!
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t max_datagram_size = 1472; // typical maximum UDP payload with an MTU of 1500 bytes
+
+    struct udp_link {
+        int tx_fd;
+        sockaddr_in address;
+    };
+
+    void send_datagram(const uint8_t* bytes, size_t length, void* context) {
+        const udp_link& link = *static_cast<udp_link*>(context);
+        ::sendto(link.tx_fd, bytes, length, 0, reinterpret_cast<const sockaddr*>(&link.address),
+                 sizeof(link.address));
+    }
+
+    // Receive until no datagram arrived for 200 ms - returns number of decoded messages
+    size_t receive_all(const int rx_fd, const bool coalesced) {
+        uint8_t buffer[max_datagram_size];
+        TestMessage3_struct_t msg {};
+        size_t num_messages = 0;
+        for(;;) {
+            const ssize_t len = ::recv(rx_fd, buffer, sizeof(buffer), 0);
+            if(len < 0) {
+                return num_messages;
+            }
+            if(!coalesced) {
+                num_messages += msg.from_bytes(buffer, static_cast<size_t>(len)) ? 1 : 0;
+                continue;
+            }
+            microbuf::container_reader reader {buffer, static_cast<size_t>(len)};
+            uint8_t type;
+            const uint8_t* bytes;
+            size_t length;
+            while(reader.next(type, bytes, length)) {
+                num_messages += msg.from_bytes(bytes, length) ? 1 : 0;
+            }
+        }
+    }
+
+    void run(const size_t num_messages, const bool coalesced) {
+        const int rx_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        udp_link link {::socket(AF_INET, SOCK_DGRAM, 0), {}};
+        link.address.sin_family = AF_INET;
+        link.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t address_len = sizeof(link.address);
+        const timeval timeout {0, 200000};
+        const int receive_buffer_size = 8*1024*1024;
+        if(rx_fd < 0 || link.tx_fd < 0 ||
+           ::bind(rx_fd, reinterpret_cast<sockaddr*>(&link.address), sizeof(link.address)) != 0 ||
+           ::getsockname(rx_fd, reinterpret_cast<sockaddr*>(&link.address), &address_len) != 0 ||
+           ::setsockopt(rx_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+            std::perror("Cannot open UDP sockets");
+            std::exit(1);
+        }
+        ::setsockopt(rx_fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size, sizeof(receive_buffer_size));
+
+        size_t num_received = 0;
+        std::thread receive_thread([&]() { num_received = receive_all(rx_fd, coalesced); });
+
+        const auto start = std::chrono::steady_clock::now();
+        microbuf::container_writer<max_datagram_size> writer {send_datagram, &link, 1};
+        TestMessage3_struct_t msg {};
+        for(size_t i=0; i<num_messages; ++i) {
+            msg.message_counter = static_cast<uint16_t>(i);
+            msg.temperature = static_cast<float>(i);
+            const auto bytes = msg.as_bytes();
+            if(coalesced) {
+                writer.add(0, bytes, static_cast<uint32_t>(i / 1000)); // "time": flush at least every 1000 messages
+            } else {
+                send_datagram(bytes.begin(), bytes.size(), &link);
+            }
+        }
+        writer.flush();
+        const auto end = std::chrono::steady_clock::now();
+        receive_thread.join();
+
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        std::printf("%-22s sent %zu messages (%zu bytes each) in %.3f s: %.0f messages/s, %zu received\n",
+                    coalesced ? "coalesced containers:" : "one datagram each:", num_messages,
+                    TestMessage3_struct_t::data_size, seconds, static_cast<double>(num_messages) / seconds,
+                    num_received);
+
+        ::close(link.tx_fd);
+        ::close(rx_fd);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t num_messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    run(num_messages, false);
+    run(num_messages, true);
+    return 0;
+}
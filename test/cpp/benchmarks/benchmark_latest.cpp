@@ -0,0 +1,90 @@
+// Latency benchmark: UDP loopback -> epoll_receiver -> latest<Msg> -> spinning real-time reader
+// The sender stores its send time in the message, the reader measures the time until the value can be read.
+
+#include "microbuf_latest.h"
+#include "microbuf_epoll_receiver.h"
+#include "TestMessage1.h" // test/messages/TestMessage1.mmsg must have been converted before trying to compile this!
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t num_messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+    const int rx_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    const int tx_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+    if(rx_fd < 0 || tx_fd < 0 || ::bind(rx_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+       ::getsockname(rx_fd, reinterpret_cast<sockaddr*>(&address), &address_len) != 0) {
+        std::perror("Cannot open UDP sockets");
+        return 1;
+    }
+
+    microbuf::latest<TestMessage1_struct_t> mailbox {};
+    microbuf::epoll_receiver receiver {};
+    if(!receiver.add(rx_fd, mailbox)) {
+        std::perror("Cannot register socket");
+        return 1;
+    }
+    std::thread receive_thread([&receiver]() { receiver.run(); });
+
+    std::vector<uint64_t> latencies_ns {};
+    latencies_ns.reserve(num_messages);
+    TestMessage1_struct_t msg {};
+    for(size_t i=0; i<num_messages; ++i) {
+        msg.uint32_val = static_cast<uint32_t>(i);
+        msg.uint64_val = now_ns();
+        const auto bytes = msg.as_bytes();
+        ::sendto(tx_fd, bytes.begin(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+
+        // spin like a real-time loop until this sample shows up (or give up after 10 ms)
+        const uint64_t deadline = msg.uint64_val + 10000000U;
+        for(;;) {
+            if(mailbox.update() && mailbox.front().uint32_val == i) {
+                latencies_ns.push_back(now_ns() - mailbox.front().uint64_val);
+                break;
+            }
+            if(now_ns() > deadline) {
+                break;
+            }
+        }
+    }
+
+    receiver.stop();
+    receive_thread.join();
+    ::close(tx_fd);
+    ::close(rx_fd);
+
+    if(latencies_ns.empty()) {
+        std::printf("No messages received\n");
+        return 1;
+    }
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    const auto percentile = [&latencies_ns](double p) {
+        return static_cast<double>(latencies_ns[static_cast<size_t>(p * (latencies_ns.size() - 1))]) / 1000.;
+    };
+    std::printf("send -> read latency of %zu/%zu messages (%zu bytes each), in us:\n", latencies_ns.size(),
+                num_messages, TestMessage1_struct_t::data_size);
+    std::printf("  min %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", percentile(0.), percentile(0.5),
+                percentile(0.9), percentile(0.99), percentile(1.));
+    std::printf("  rejected datagrams: %llu\n", static_cast<unsigned long long>(receiver.num_rejected()));
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Throughput benchmark: serialization and deserialization of one large message, serial vs. split across a thread pool
+
+#include "microbuf_parallel.h"
+#include "TestMessage5.h" // test/messages/TestMessage5.mmsg must have been converted before trying to compile this!
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+    using bytes_t = microbuf::array<uint8_t, TestMessage5_struct_t::data_size>;
+
+    // Returns the mean duration of one call of f in milliseconds
+    template<typename F>
+    double measure(const size_t num_iterations, F f) {
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t i=0; i<num_iterations; ++i) {
+            f();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / static_cast<double>(num_iterations);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const size_t num_iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    const size_t num_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : microbuf::thread_pool::default_num_threads();
+
+    std::unique_ptr<TestMessage5_struct_t> msg {new TestMessage5_struct_t {}};
+    for(size_t i=0; i<300000; ++i) {
+        msg->points[i] = static_cast<float>(i) * 0.01f;
+    }
+    std::unique_ptr<bytes_t> bytes {new bytes_t {}};
+    microbuf::thread_pool pool {num_threads};
+
+    bool worked = true;
+    const double serial_to = measure(num_iterations, [&]() { msg->to_bytes(*bytes); });
+    const double parallel_to = measure(num_iterations, [&]() { msg->to_bytes(*bytes, pool); });
+    const double serial_from = measure(num_iterations, [&]() { worked = msg->from_bytes(*bytes) && worked; });
+    const double parallel_from = measure(num_iterations, [&]() { worked = msg->from_bytes(*bytes, pool) && worked; });
+
+    std::printf("%zu bytes per message, %zu additional threads\n", TestMessage5_struct_t::data_size, num_threads);
+    std::printf("to_bytes:   serial %.3f ms, parallel %.3f ms (speedup %.2f)\n", serial_to, parallel_to,
+                serial_to / parallel_to);
+    std::printf("from_bytes: serial %.3f ms, parallel %.3f ms (speedup %.2f)%s\n", serial_from, parallel_from,
+                serial_from / parallel_from, worked ? "" : " - DESERIALIZATION FAILED");
+    return worked ? 0 : 1;
+}
@@ -2,6 +2,7 @@
 #include "gmock/gmock.h"
 #include "SensorData.h" // SensorData.mmsg must have been converted before trying to compile this!
 #include <iostream>
+#include <vector>
 
 TEST(microbuf_cpp_SensorData, serialize_then_deserialize)
 {
@@ -27,4 +28,98 @@ TEST(microbuf_cpp_SensorData, serialize_then_deserialize)
     auto wrong_serialized_bytes = serialized_bytes;
     wrong_serialized_bytes[5] = 0xf0;
     EXPECT_FALSE(sensor_data2.from_bytes(wrong_serialized_bytes));
-}
\ No newline at end of file
+
+    // in place from any buffer with at least data_size bytes
+    std::vector<uint8_t> buffer(serialized_bytes.begin(), serialized_bytes.end());
+    buffer.push_back(0x00);
+    SensorData_struct_t sensor_data3 {};
+    EXPECT_FALSE(sensor_data3.from_bytes(buffer.data(), SensorData_struct_t::data_size-1));
+    EXPECT_TRUE(sensor_data3.from_bytes(buffer.data(), buffer.size()));
+    EXPECT_EQ(sensor_data3.robot_id, 42U);
+    EXPECT_THAT(sensor_data3.distance, ElementsAre(0., 1., 2., 3., 4., 5., 6., 7., 8., 9.));
+}
+
+TEST(microbuf_cpp_SensorData, extract_columns)
+{
+    // record 100 messages back to back
+    constexpr size_t num_frames = 100;
+    std::vector<uint8_t> recording(num_frames * SensorData_struct_t::data_size);
+    for(size_t i=0; i<num_frames; ++i)
+    {
+        SensorData_struct_t sensor_data {};
+        sensor_data.robot_id = static_cast<uint8_t>(i);
+        sensor_data.angle[3] = 0.5f * i;
+        const auto bytes = sensor_data.as_bytes();
+        std::copy(bytes.begin(), bytes.end(), recording.begin() + i * SensorData_struct_t::data_size);
+    }
+
+    uint8_t robot_ids[num_frames] {};
+    float angles[num_frames] {};
+    EXPECT_EQ(SensorData_struct_t::extract_robot_id(recording.data(), num_frames, robot_ids), num_frames);
+    EXPECT_EQ(SensorData_struct_t::extract_angle<3>(recording.data(), num_frames, angles, true), num_frames);
+    for(size_t i=0; i<num_frames; ++i)
+    {
+        EXPECT_EQ(robot_ids[i], i);
+        EXPECT_EQ(angles[i], 0.5f * i);
+    }
+
+    // corrupt a distance value of frame 7: prefix of other fields stays fine, but the CRC fails
+    recording[7 * SensorData_struct_t::data_size + 5] = 0xf0;
+    bool valid[num_frames] {};
+    EXPECT_EQ(SensorData_struct_t::extract_robot_id(recording.data(), num_frames, robot_ids), num_frames);
+    EXPECT_EQ(SensorData_struct_t::extract_robot_id(recording.data(), num_frames, robot_ids, true, valid),
+              num_frames - 1);
+    EXPECT_FALSE(valid[7]);
+    EXPECT_TRUE(valid[8]);
+    EXPECT_EQ(robot_ids[7], 0U);
+    EXPECT_EQ(robot_ids[8], 8U);
+}
+
+TEST(microbuf_cpp_SensorData, push_byte)
+{
+    SensorData_struct_t sensor_data {};
+    for(size_t i=0; i<10; ++i)
+    {
+        sensor_data.distance[i] = i;
+        sensor_data.angle[i] = 10+i;
+    }
+    sensor_data.robot_id = 42U;
+    const auto bytes = sensor_data.as_bytes();
+
+    // fields are complete as soon as their last byte arrived
+    SensorData_struct_t received {};
+    microbuf::push_state state {};
+    for(size_t i=0; i<bytes.size()-1; ++i) {
+        ASSERT_EQ(received.push_byte(state, bytes[i]), microbuf::push_result::in_progress);
+        if(i == 11) {
+            EXPECT_EQ(received.distance[1], 0.f);
+        }
+        if(i == 12) {
+            EXPECT_EQ(received.distance[1], 1.f);
+        }
+    }
+    EXPECT_EQ(received.push_byte(state, bytes[bytes.size()-1]), microbuf::push_result::done);
+    EXPECT_EQ(received.robot_id, 42U);
+    using namespace testing;
+    EXPECT_THAT(received.angle, ElementsAre(10., 11., 12., 13., 14., 15., 16., 17., 18., 19.));
+    EXPECT_EQ(received.push_byte(state, 0x00), microbuf::push_result::failed); // message is already complete
+
+    // wrong prefix is detected right away
+    state.reset();
+    EXPECT_EQ(received.push_byte(state, bytes[0]), microbuf::push_result::in_progress);
+    EXPECT_EQ(received.push_byte(state, 0xdd), microbuf::push_result::failed);
+
+    // wrong data is detected by the CRC at the end
+    auto wrong_bytes = bytes;
+    wrong_bytes[5] = 0xf0;
+    state.reset();
+    microbuf::push_result result {};
+    for(const uint8_t byte : wrong_bytes) {
+        result = received.push_byte(state, byte);
+        if(result != microbuf::push_result::in_progress) {
+            break;
+        }
+    }
+    EXPECT_EQ(result, microbuf::push_result::failed);
+    EXPECT_GE(state.index, bytes.size()-3);
+}
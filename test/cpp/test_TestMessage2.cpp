@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "TestMessage2.h"
+#include <cmath>
+#include <random>
+
+TEST(microbuf_cpp_TestMessage2, serialize_then_deserialize)
+{
+    TestMessage2_struct_t msg{};
+    msg.uint16_val = 1234U;
+    for(size_t i=0; i<4; ++i)
+    {
+        msg.float32_arr_val[i] = i;
+    }
+    // slowly changing values compress well
+    for(size_t i=0; i<16; ++i)
+    {
+        msg.samples[i] = 10.f + (i/4) * 0.5f;
+    }
+    for(size_t i=0; i<300; ++i)
+    {
+        msg.spectrum[i] = static_cast<float>(i/10);
+    }
+
+    microbuf::array<uint8_t, TestMessage2_struct_t::data_size> bytes {};
+    const size_t length = msg.to_bytes(bytes);
+    EXPECT_LT(length, TestMessage2_struct_t::data_size / 2);
+    EXPECT_GE(length, TestMessage2_struct_t::min_data_size);
+
+    TestMessage2_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_bytes(bytes, length));
+    EXPECT_EQ(msg2.uint16_val, 1234U);
+    using namespace testing;
+    EXPECT_THAT(msg2.float32_arr_val, ElementsAre(0., 1., 2., 3.));
+    EXPECT_THAT(msg2.samples, ElementsAreArray(msg.samples));
+    EXPECT_THAT(msg2.spectrum, ElementsAreArray(msg.spectrum));
+
+    // wrong length or changed byte
+    EXPECT_FALSE(msg2.from_bytes(bytes, length-1));
+    EXPECT_FALSE(msg2.from_bytes(bytes, length+1));
+    auto wrong_bytes = bytes;
+    wrong_bytes[30] ^= 0x01U;
+    EXPECT_FALSE(msg2.from_bytes(wrong_bytes, length));
+}
+
+TEST(microbuf_cpp_TestMessage2, worst_case_size)
+{
+    TestMessage2_struct_t msg{};
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<float> distribution {-1e6, 1e6};
+    for(auto& value : msg.spectrum)
+    {
+        value = distribution(generator);
+    }
+    msg.samples[3] = NAN;
+
+    microbuf::array<uint8_t, TestMessage2_struct_t::data_size> bytes {};
+    const size_t length = msg.to_bytes(bytes);
+    EXPECT_LE(length, TestMessage2_struct_t::data_size);
+
+    TestMessage2_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_bytes(bytes, length));
+    EXPECT_TRUE(std::isnan(msg2.samples[3]));
+    EXPECT_EQ(0, memcmp(msg.spectrum, msg2.spectrum, sizeof(msg.spectrum)));
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "TestMessage4.h" // test/messages/TestMessage4.mmsg must have been converted before trying to compile this!
+#include <iostream>
+#include <fstream>
+#include <string>
+
+TEST(microbuf_cpp_TestMessage4, absent_fields_are_not_sent)
+{
+    TestMessage4_struct_t msg{};
+    msg.mode = 3U;
+    msg.counter = 123456U;
+    msg.lidar[0] = 1.f; // not sent without set_has_lidar()
+
+    microbuf::array<uint8_t, TestMessage4_struct_t::data_size> bytes {};
+    const size_t length = msg.to_bytes(bytes);
+    EXPECT_EQ(length, TestMessage4_struct_t::min_data_size);
+
+    TestMessage4_struct_t msg2{};
+    msg2.battery_low = true;
+    msg2.set_has_battery_low();
+    EXPECT_TRUE(msg2.from_bytes(bytes, length));
+    EXPECT_EQ(msg2.mode, 3U);
+    EXPECT_EQ(msg2.counter, 123456U);
+    EXPECT_FALSE(msg2.has_position());
+    EXPECT_FALSE(msg2.has_lidar());
+    EXPECT_FALSE(msg2.has_battery_low());
+    EXPECT_FALSE(msg2.has_samples());
+    EXPECT_EQ(msg2.lidar[0], 0.f);
+}
+
+TEST(microbuf_cpp_TestMessage4, present_fields_are_sent)
+{
+    TestMessage4_struct_t msg{};
+    msg.mode = 1U;
+    msg.position[0] = 1.5;
+    msg.position[2] = -2.5;
+    msg.set_has_position();
+    msg.battery_low = true;
+    msg.set_has_battery_low();
+    for(size_t i=0; i<16; ++i)
+    {
+        msg.samples[i] = static_cast<float>(i/8);
+    }
+    msg.set_has_samples();
+    msg.counter = 42U;
+
+    microbuf::array<uint8_t, TestMessage4_struct_t::data_size> bytes {};
+    const size_t length = msg.to_bytes(bytes);
+    EXPECT_LT(length, 100U); // lidar is not sent
+
+    TestMessage4_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_bytes(bytes.begin(), length));
+    EXPECT_TRUE(msg2.has_position());
+    EXPECT_FALSE(msg2.has_lidar());
+    EXPECT_TRUE(msg2.has_battery_low());
+    EXPECT_TRUE(msg2.has_samples());
+    using namespace testing;
+    EXPECT_THAT(msg2.position, ElementsAre(1.5, 0., -2.5));
+    EXPECT_EQ(msg2.battery_low, true);
+    EXPECT_THAT(msg2.samples, ElementsAreArray(msg.samples));
+    EXPECT_EQ(msg2.counter, 42U);
+
+    // all fields present
+    msg.set_has_lidar();
+    msg.lidar[359] = 3.f;
+    const size_t full_length = msg.to_bytes(bytes);
+    EXPECT_EQ(full_length, length + 360U * 5U);
+    EXPECT_TRUE(msg2.from_bytes(bytes, full_length));
+    EXPECT_TRUE(msg2.has_lidar());
+    EXPECT_EQ(msg2.lidar[359], 3.f);
+
+    // presence which does not match the data, unknown optional field or changed byte
+    auto wrong_bytes = bytes;
+    wrong_bytes[4] &= static_cast<uint8_t>(~0x01U);
+    EXPECT_FALSE(msg2.from_bytes(wrong_bytes, full_length));
+    wrong_bytes = bytes;
+    wrong_bytes[4] |= 0x10U;
+    EXPECT_FALSE(msg2.from_bytes(wrong_bytes, full_length));
+    wrong_bytes = bytes;
+    wrong_bytes[20] ^= 0x01U;
+    EXPECT_FALSE(msg2.from_bytes(wrong_bytes, full_length));
+
+    msg.set_has_lidar(false);
+    EXPECT_FALSE(msg.has_lidar());
+    EXPECT_TRUE(msg.has_position());
+}
+
+TEST(microbuf_cpp_TestMessage4, write_presence_combinations)
+{
+    // one file per combination of optional fields for the MATLAB deserialization test
+    const char* names[] {"none", "position", "lidar_battery_low", "all"};
+    const uint8_t presences[] {0x0U, 0x1U, 0x6U, 0xfU};
+    for(uint8_t combination=0; combination<4; ++combination)
+    {
+        TestMessage4_struct_t msg{};
+        msg.presence = presences[combination];
+        msg.mode = combination;
+        msg.position[0] = 1.5;
+        msg.position[1] = -2.5;
+        msg.position[2] = 4.;
+        for(size_t i=0; i<360; ++i)
+        {
+            msg.lidar[i] = static_cast<float>(i) * 0.5f;
+        }
+        msg.battery_low = true;
+        for(size_t i=0; i<16; ++i)
+        {
+            msg.samples[i] = static_cast<float>(i/8);
+        }
+        msg.counter = 123456U + combination;
+
+        microbuf::array<uint8_t, TestMessage4_struct_t::data_size> bytes {};
+        const size_t length = msg.to_bytes(bytes);
+
+        const std::string filename = std::string("TestMessage4_") + names[combination] + "_serialized_by_cpp.bin";
+        std::cout << "Printing content of TestMessage4 as binary to file " << filename << "\n";
+        std::ofstream ofs(filename, std::ios::binary);
+        if (!ofs) {
+            std::cerr << "Cannot write to "<<filename<< " - aborting";
+            FAIL();
+            return;
+        }
+        ofs.write(reinterpret_cast<const char *>(bytes.begin()), static_cast<std::streamsize>(length));
+    }
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "microbuf_parallel.h"
+#include "TestMessage5.h" // test/messages/TestMessage5.mmsg must have been converted before trying to compile this!
+#include <memory>
+
+namespace {
+    constexpr size_t data_size = TestMessage5_struct_t::data_size;
+    using bytes_t = microbuf::array<uint8_t, data_size>;
+
+    std::unique_ptr<TestMessage5_struct_t> make_message()
+    {
+        std::unique_ptr<TestMessage5_struct_t> msg {new TestMessage5_struct_t {}};
+        msg->frame_id = 77U;
+        for(size_t i=0; i<300000; ++i)
+        {
+            msg->points[i] = static_cast<float>(i) * 0.25f - 1000.f;
+        }
+        for(size_t i=0; i<100000; ++i)
+        {
+            msg->intensities[i] = static_cast<uint16_t>(i * 3);
+            msg->valid[i] = (i % 3) == 0;
+        }
+        msg->timestamp = 1234.5;
+        return msg;
+    }
+}
+
+TEST(microbuf_cpp_TestMessage5, parallel_bytes_are_identical)
+{
+    const auto msg = make_message();
+    std::unique_ptr<bytes_t> serial_bytes {new bytes_t {}};
+    std::unique_ptr<bytes_t> parallel_bytes {new bytes_t {}};
+    EXPECT_EQ(msg->to_bytes(*serial_bytes), data_size);
+
+    microbuf::thread_pool pool {3};
+    EXPECT_EQ(msg->to_bytes(*parallel_bytes, pool), data_size);
+    EXPECT_TRUE(*parallel_bytes == *serial_bytes);
+
+    microbuf::serial_executor executor {};
+    std::unique_ptr<bytes_t> executor_bytes {new bytes_t {}};
+    msg->to_bytes(*executor_bytes, executor);
+    EXPECT_TRUE(*executor_bytes == *serial_bytes);
+}
+
+TEST(microbuf_cpp_TestMessage5, parallel_from_bytes)
+{
+    const auto msg = make_message();
+    std::unique_ptr<bytes_t> bytes {new bytes_t {}};
+    msg->to_bytes(*bytes);
+
+    microbuf::thread_pool pool {3};
+    std::unique_ptr<TestMessage5_struct_t> msg2 {new TestMessage5_struct_t {}};
+    EXPECT_TRUE(msg2->from_bytes(*bytes, pool));
+    EXPECT_EQ(msg2->frame_id, 77U);
+    EXPECT_EQ(msg2->points[299999], msg->points[299999]);
+    EXPECT_EQ(msg2->intensities[12345], msg->intensities[12345]);
+    EXPECT_EQ(msg2->valid[99999], msg->valid[99999]);
+    EXPECT_EQ(msg2->timestamp, 1234.5);
+    EXPECT_EQ(memcmp(msg2->points, msg->points, sizeof(msg->points)), 0);
+
+    // the pool can be used several times; wrong bytes in any chunk or a wrong CRC are detected
+    const size_t positions[] {11, 750000, 1500011, 1900000, data_size-1};
+    for(const size_t position : positions)
+    {
+        (*bytes)[position] ^= 0x10U;
+        EXPECT_FALSE(msg2->from_bytes(*bytes, pool)) << position;
+        EXPECT_FALSE(msg2->from_bytes(*bytes)) << position;
+        (*bytes)[position] ^= 0x10U;
+    }
+    EXPECT_TRUE(msg2->from_bytes(bytes->begin(), bytes->size(), pool));
+    EXPECT_FALSE(msg2->from_bytes(bytes->begin(), bytes->size()-1, pool));
+}
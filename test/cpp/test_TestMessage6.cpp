@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "TestMessage6.h" // test/messages/TestMessage6.mmsg must have been converted before trying to compile this!
+
+TEST(microbuf_cpp_TestMessage6, crc32c_trailer)
+{
+    TestMessage6_struct_t msg{};
+    msg.sequence = 0xdeadbeefU;
+    for(uint8_t i=0; i<8; ++i)
+    {
+        msg.values[i] = i * 0.5f;
+    }
+    msg.flags[1] = true;
+
+    const auto bytes = msg.as_bytes();
+    ASSERT_EQ(bytes.size(), 1U + 5U + 8U * 5U + 2U + 5U);
+    EXPECT_EQ(bytes[bytes.size()-5], 0xce);
+    EXPECT_EQ(microbuf::internal::from_big_endian<uint32_t>(bytes.end()-4),
+              microbuf::internal::crc32c(bytes.begin(), bytes.size()-5));
+
+    TestMessage6_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_bytes(bytes));
+    using namespace testing;
+    EXPECT_EQ(msg2.sequence, 0xdeadbeefU);
+    EXPECT_THAT(msg2.values, ElementsAre(0.f, .5f, 1.f, 1.5f, 2.f, 2.5f, 3.f, 3.5f));
+    EXPECT_THAT(msg2.flags, ElementsAre(false, true));
+
+    // any changed byte is detected, including the CRC itself
+    for(size_t i=0; i<bytes.size(); ++i)
+    {
+        auto wrong_bytes = bytes;
+        wrong_bytes[i] ^= 0x04U;
+        EXPECT_FALSE(msg2.from_bytes(wrong_bytes)) << i;
+    }
+
+    // extraction with CRC check
+    uint8_t frames[2 * TestMessage6_struct_t::data_size];
+    memcpy(frames, bytes.begin(), bytes.size());
+    memcpy(frames + bytes.size(), bytes.begin(), bytes.size());
+    frames[bytes.size() + 10] ^= 0x01U;
+    uint32_t sequences[2];
+    bool valid[2];
+    EXPECT_EQ(TestMessage6_struct_t::extract_sequence(frames, 2, sequences, true, valid), 1U);
+    EXPECT_EQ(sequences[0], 0xdeadbeefU);
+    EXPECT_THAT(valid, ElementsAre(true, false));
+}
+
+TEST(microbuf_cpp_TestMessage6, native_format_with_crc32c)
+{
+    TestMessage6_struct_t msg{};
+    msg.sequence = 17U;
+    msg.values[7] = -1.f;
+
+    auto native_bytes = msg.as_native_bytes();
+    ASSERT_EQ(native_bytes.size(), 4U + sizeof(TestMessage6_struct_t) + 4U);
+
+    TestMessage6_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_native_bytes(native_bytes));
+    EXPECT_EQ(msg2.sequence, 17U);
+    EXPECT_EQ(msg2.values[7], -1.f);
+
+    native_bytes[8] ^= 0x01U;
+    EXPECT_FALSE(msg2.from_native_bytes(native_bytes));
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "TestMessage7.h" // test/messages/TestMessage7.mmsg must have been converted before trying to compile this!
+
+TEST(microbuf_cpp_TestMessage7, native_format)
+{
+    TestMessage7_struct_t msg{};
+    msg.valid = true;
+    msg.sequence = 0x1234U;
+    msg.timestamp_us = 0x0102030405060708U;
+    for(int8_t i=0; i<10; ++i)
+    {
+        msg.ranges[i] = i;
+        msg.poses[i] = -i;
+    }
+
+    const auto native_bytes = msg.as_native_bytes();
+    ASSERT_EQ(native_bytes.size(), 4U + sizeof(TestMessage7_struct_t) + 2U);
+
+    TestMessage7_struct_t msg2{};
+    EXPECT_TRUE(msg2.from_native_bytes(native_bytes));
+
+    using namespace testing;
+    EXPECT_EQ(msg2.valid, true);
+    EXPECT_EQ(msg2.sequence, 0x1234U);
+    EXPECT_EQ(msg2.timestamp_us, 0x0102030405060708U);
+    EXPECT_THAT(msg2.ranges, ElementsAre(0., 1., 2., 3., 4., 5., 6., 7., 8., 9.));
+    EXPECT_THAT(msg2.poses, ElementsAre(0., -1., -2., -3., -4., -5., -6., -7., -8., -9.));
+
+    // change a byte so CRC fails
+    auto wrong_bytes = native_bytes;
+    wrong_bytes[20] ^= 0x01U;
+    EXPECT_FALSE(msg2.from_native_bytes(wrong_bytes));
+
+    // schema hash of another message version
+    wrong_bytes = native_bytes;
+    wrong_bytes[0] ^= 0x01U;
+    EXPECT_FALSE(msg2.from_native_bytes(wrong_bytes));
+
+    // invalid bool value with a matching CRC
+    TestMessage7_struct_t msg3{};
+    msg3.mode = 2U;
+    wrong_bytes = msg3.as_native_bytes();
+    EXPECT_TRUE(msg2.from_native_bytes(wrong_bytes));
+    wrong_bytes[4] = 2U;
+    const uint16_t crc = microbuf::internal::crc16_aug_ccitt(wrong_bytes.begin(), wrong_bytes.size()-2);
+    memcpy(wrong_bytes.begin()+wrong_bytes.size()-2, &crc, sizeof(crc));
+    EXPECT_FALSE(msg2.from_native_bytes(wrong_bytes));
+
+    // msgpack format is still available next to the native one
+    EXPECT_TRUE(msg2.from_bytes(msg.as_bytes()));
+    EXPECT_EQ(msg2.sequence, 0x1234U);
+}
+
+TEST(microbuf_cpp_TestMessage7, native_padding_is_zero)
+{
+    // padding between sequence and timestamp_us and of a struct which was not value-initialized
+    TestMessage7_struct_t msg;
+    memset(&msg, 0xab, sizeof(msg));
+    msg.valid = true;
+    msg.mode = 1U;
+    msg.sequence = 2U;
+    msg.timestamp_us = 3U;
+    for(size_t i=0; i<10; ++i)
+    {
+        msg.ranges[i] = 4.f;
+        msg.poses[i] = 5.;
+    }
+
+    const auto native_bytes = msg.as_native_bytes();
+    for(size_t i=4+offsetof(TestMessage7_struct_t, sequence)+2; i<4+offsetof(TestMessage7_struct_t, timestamp_us); ++i)
+    {
+        EXPECT_EQ(native_bytes[i], 0U) << i;
+    }
+
+    // same bytes as for a value-initialized struct with the same fields
+    TestMessage7_struct_t msg2{};
+    msg2.valid = true;
+    msg2.mode = 1U;
+    msg2.sequence = 2U;
+    msg2.timestamp_us = 3U;
+    for(size_t i=0; i<10; ++i)
+    {
+        msg2.ranges[i] = 4.f;
+        msg2.poses[i] = 5.;
+    }
+    EXPECT_TRUE(native_bytes == msg2.as_native_bytes());
+    EXPECT_TRUE(msg2.from_native_bytes(native_bytes));
+}
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+#include "microbuf_container.h"
+#include "SensorData.h"
+#include "TestMessage2.h"
+#include "TestMessage3.h"
+#include <vector>
+
+namespace {
+    void store_container(const uint8_t* bytes, size_t length, void* context) {
+        auto& containers = *static_cast<std::vector<std::vector<uint8_t>>*>(context);
+        containers.emplace_back(bytes, bytes+length);
+    }
+
+    enum message_types : uint8_t { sensor_data_type, test_message2_type, test_message3_type };
+    constexpr size_t test_message3_size = TestMessage3_struct_t::data_size;
+}
+
+TEST(microbuf_cpp_container, pack_then_walk)
+{
+    std::vector<std::vector<uint8_t>> containers {};
+    microbuf::container_writer<320> writer {store_container, &containers, 100};
+
+    SensorData_struct_t sensor_data {};
+    sensor_data.robot_id = 42;
+    TestMessage2_struct_t msg2 {};
+    msg2.uint16_val = 2;
+    TestMessage3_struct_t msg3 {};
+
+    EXPECT_TRUE(writer.add_message(sensor_data_type, sensor_data, 0));
+    EXPECT_TRUE(writer.add_message(test_message2_type, msg2, 0)); // variable size
+    for(uint8_t i=0; i<3; ++i) {
+        msg3.message_counter = static_cast<uint16_t>(1000U + i);
+        msg3.error_flags[i] = true;
+        EXPECT_TRUE(writer.add(test_message3_type, msg3.as_bytes(), 1));
+    }
+    EXPECT_TRUE(containers.empty());
+    EXPECT_EQ(writer.num_messages(), 5U);
+
+    // too large or invalid type
+    EXPECT_FALSE(writer.add(test_message3_type, microbuf::array<uint8_t, 317>{}, 1));
+    EXPECT_FALSE(writer.add(128, msg3.as_bytes(), 1));
+
+    // next message does not fit anymore
+    EXPECT_TRUE(writer.add_message(sensor_data_type, sensor_data, 2));
+    ASSERT_EQ(containers.size(), 1U);
+    EXPECT_EQ(writer.num_messages(), 1U);
+
+    // deadline
+    writer.poll(101);
+    EXPECT_EQ(containers.size(), 1U);
+    writer.poll(102);
+    ASSERT_EQ(containers.size(), 2U);
+    EXPECT_EQ(writer.size(), 0U);
+
+    microbuf::container_reader reader {containers[0].data(), containers[0].size()};
+    uint8_t type {};
+    const uint8_t* bytes {};
+    size_t length {};
+
+    ASSERT_TRUE(reader.next(type, bytes, length));
+    EXPECT_EQ(type, sensor_data_type);
+    SensorData_struct_t sensor_data2 {};
+    EXPECT_TRUE(sensor_data2.from_bytes(bytes, length)); // in place from the container
+    EXPECT_EQ(sensor_data2.robot_id, 42);
+
+    ASSERT_TRUE(reader.next(type, bytes, length));
+    EXPECT_EQ(type, test_message2_type);
+    EXPECT_LT(length, TestMessage2_struct_t::data_size);
+    TestMessage2_struct_t msg2_received {};
+    EXPECT_TRUE(msg2_received.from_bytes(bytes, length));
+    EXPECT_EQ(msg2_received.uint16_val, 2U);
+
+    for(uint8_t i=0; i<3; ++i) {
+        ASSERT_TRUE(reader.next(type, bytes, length));
+        EXPECT_EQ(type, test_message3_type);
+        TestMessage3_struct_t msg3_received {};
+        EXPECT_EQ(length, test_message3_size);
+        EXPECT_TRUE(msg3_received.from_bytes(bytes, length));
+        EXPECT_EQ(msg3_received.message_counter, 1000U + i);
+        EXPECT_TRUE(msg3_received.error_flags[i]);
+    }
+    EXPECT_FALSE(reader.next(type, bytes, length));
+    EXPECT_FALSE(reader.error());
+
+    // truncated container
+    microbuf::container_reader reader2 {containers[0].data(), containers[0].size()-1};
+    size_t num_messages = 0;
+    while(reader2.next(type, bytes, length)) {
+        ++num_messages;
+    }
+    EXPECT_EQ(num_messages, 4U);
+    EXPECT_TRUE(reader2.error());
+}
+
+TEST(microbuf_cpp_container, entries_of_other_types_are_rejected)
+{
+    std::vector<std::vector<uint8_t>> containers {};
+    microbuf::container_writer<320> writer {store_container, &containers, 100};
+
+    SensorData_struct_t sensor_data {};
+    TestMessage3_struct_t msg3 {};
+    msg3.message_counter = 7;
+    EXPECT_TRUE(writer.add_message(sensor_data_type, sensor_data, 0));
+    EXPECT_TRUE(writer.add_message(test_message3_type, msg3, 0));
+    // a message with the wrong length for its type, e.g. from an older sender
+    EXPECT_TRUE(writer.add(test_message3_type, sensor_data.as_bytes(), 0));
+    writer.flush();
+    ASSERT_EQ(containers.size(), 1U);
+
+    microbuf::container_reader reader {containers[0].data(), containers[0].size()};
+    uint8_t type {};
+    const uint8_t* bytes {};
+    size_t length {};
+    SensorData_struct_t sensor_data2 {};
+    TestMessage3_struct_t msg3_received {};
+
+    // each message only decodes as its own type
+    ASSERT_TRUE(reader.next(type, bytes, length));
+    EXPECT_EQ(type, sensor_data_type);
+    EXPECT_FALSE(msg3_received.from_bytes(bytes, length));
+    EXPECT_TRUE(sensor_data2.from_bytes(bytes, length));
+
+    ASSERT_TRUE(reader.next(type, bytes, length));
+    EXPECT_EQ(type, test_message3_type);
+    EXPECT_FALSE(sensor_data2.from_bytes(bytes, length));
+    EXPECT_TRUE(msg3_received.from_bytes(bytes, length));
+    EXPECT_EQ(msg3_received.message_counter, 7U);
+
+    ASSERT_TRUE(reader.next(type, bytes, length));
+    EXPECT_EQ(type, test_message3_type);
+    EXPECT_NE(length, test_message3_size);
+    EXPECT_FALSE(msg3_received.from_bytes(bytes, length));
+
+    EXPECT_FALSE(reader.next(type, bytes, length));
+    EXPECT_FALSE(reader.error());
+}
@@ -90,6 +90,30 @@ TEST(microbuf_cpp_deserialization, float64)
     EXPECT_FALSE((microbuf::parse_float64<0>(microbuf::array<uint8_t,9>{0xcc, 0x40, 0x12, 0x3D, 0x70, 0xA3, 0xD7, 0x0A, 0x3D}, result)));
 }
 
+TEST(microbuf_cpp_deserialization, from_pointer)
+{
+    // e.g. a receive buffer: fields are parsed in place at their offsets, the length is checked at runtime
+    const uint8_t bytes[] {0x93, 0xc3, 0xcd, 0xa4, 0x10, 0xca, 0x3f, 0x9d, 0x70, 0xa4, 0xca, 0x40, 0x91, 0xeb, 0x85};
+    bool bool_result {};
+    uint16_t uint16_result {};
+    float float32_result[2] {};
+    EXPECT_TRUE(microbuf::check_fixarray<0>(bytes, sizeof(bytes), 3));
+    EXPECT_TRUE(microbuf::parse_bool<1>(bytes, sizeof(bytes), bool_result));
+    EXPECT_TRUE(microbuf::parse_uint16<2>(bytes, sizeof(bytes), uint16_result));
+    EXPECT_TRUE((microbuf::parse_multiple<2, 5>(bytes, sizeof(bytes), float32_result, microbuf::parse_float32<0>)));
+    EXPECT_EQ(bool_result, true);
+    EXPECT_EQ(uint16_result, 42000U);
+    EXPECT_EQ(float32_result[0], static_cast<float>(1.23));
+    EXPECT_EQ(float32_result[1], static_cast<float>(4.56));
+
+    // fields behind length are never read
+    EXPECT_FALSE(microbuf::check_array16<0>(bytes, 2, 1));
+    EXPECT_FALSE(microbuf::parse_bool<1>(bytes, 1, bool_result));
+    EXPECT_FALSE(microbuf::parse_uint16<2>(bytes, 4, uint16_result));
+    EXPECT_FALSE((microbuf::parse_multiple<2, 5>(bytes, sizeof(bytes)-1, float32_result, microbuf::parse_float32<0>)));
+    EXPECT_FALSE(microbuf::parse_uint16<1>(bytes, sizeof(bytes), uint16_result)); // wrong prefix
+}
+
 TEST(microbuf_cpp_deserialization, verify_crc)
 {
     const microbuf::array<uint8_t, 13> valid_bytes{0x91, 0xcf, 0x11, 0x22, 0x10, 0xf4, 0x7d, 0xe9, 0x81, 0x15, 0xcd,
@@ -103,6 +127,30 @@ TEST(microbuf_cpp_deserialization, verify_crc)
     EXPECT_FALSE(microbuf::verify_crc(bytes));
     bytes = valid_bytes; bytes[10] = 0xcc;
     EXPECT_FALSE(microbuf::verify_crc(bytes));
+
+    EXPECT_TRUE(microbuf::verify_crc(valid_bytes.begin(), valid_bytes.size()));
+    EXPECT_FALSE(microbuf::verify_crc(valid_bytes.begin(), valid_bytes.size()-1));
+    EXPECT_FALSE(microbuf::verify_crc(valid_bytes.begin(), 2));
+}
+
+TEST(microbuf_cpp_deserialization, extract_column)
+{
+    // three frames with 3 bytes stride: bool, uint8
+    const uint8_t frames[] {0xc3, 0xcc, 0x01,
+                            0xc2, 0xcc, 0x02,
+                            0xc4, 0xcd, 0x03};
+    bool bools[3] {};
+    uint8_t uint8s[3] {};
+    bool valid[3] {};
+    EXPECT_EQ((microbuf::extract_column<0, 3>(frames, 3, bools)), 2U);
+    EXPECT_EQ((microbuf::extract_column<1, 3>(frames, 3, uint8s, false, valid)), 2U);
+    EXPECT_EQ(bools[0], true);
+    EXPECT_EQ(bools[1], false);
+    EXPECT_EQ(uint8s[0], 1U);
+    EXPECT_EQ(uint8s[1], 2U);
+    EXPECT_EQ(uint8s[2], 0U);
+    EXPECT_TRUE(valid[1]);
+    EXPECT_FALSE(valid[2]);
 }
 
 TEST(microbuf_cpp_deserialization, uint16_multi) {
@@ -141,3 +189,26 @@ TEST(microbuf_cpp_deserialization, float32_multi) {
             },
             result2, microbuf::parse_float32<0>)));
 }
+
+TEST(microbuf_cpp_deserialization, xor_delta)
+{
+    const microbuf::array<uint8_t, 11> bytes {0x00, 0xc4, 0x08, 0x01, 0x3f, 0x80, 0x00, 0x00, 0x61, 0x3f, 0xf8};
+    float result[3] {};
+    size_t index = 1;
+    EXPECT_TRUE(microbuf::parse_xor_delta(bytes, bytes.size(), index, result));
+    EXPECT_EQ(index, 11U);
+    EXPECT_EQ(result[0], 1.f);
+    EXPECT_EQ(result[1], 1.f);
+    EXPECT_EQ(result[2], 2.f);
+
+    index = 1;
+    EXPECT_FALSE(microbuf::parse_xor_delta(bytes, bytes.size()-1, index, result)); // too short
+    EXPECT_EQ(index, 1U);
+
+    float result2[2] {};
+    const microbuf::array<uint8_t, 11> raw_bytes {0xc4, 0x09, 0x00, 0x3f, 0x9d, 0x70, 0xa4, 0xc0, 0x91, 0xeb, 0x85};
+    index = 0;
+    EXPECT_TRUE(microbuf::parse_xor_delta(raw_bytes, raw_bytes.size(), index, result2));
+    EXPECT_EQ(result2[0], static_cast<float>(1.23));
+    EXPECT_EQ(result2[1], static_cast<float>(-4.56));
+}
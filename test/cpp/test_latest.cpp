@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "microbuf_latest.h"
+#include "microbuf_epoll_receiver.h"
+#include "SensorData.h" // SensorData.mmsg must have been converted before trying to compile this!
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+
+TEST(microbuf_cpp_latest, only_newest_value_is_read)
+{
+    microbuf::latest<int> mailbox {};
+    EXPECT_FALSE(mailbox.update());
+    EXPECT_EQ(mailbox.front(), 0);
+
+    mailbox.publish(1);
+    mailbox.publish(2);
+    mailbox.back() = 3;
+    mailbox.publish();
+
+    EXPECT_TRUE(mailbox.update());
+    EXPECT_EQ(mailbox.front(), 3);
+    EXPECT_FALSE(mailbox.update());
+    EXPECT_EQ(mailbox.front(), 3); // front stays valid
+
+    int result {};
+    mailbox.publish(4);
+    EXPECT_TRUE(mailbox.read(result));
+    EXPECT_EQ(result, 4);
+    EXPECT_FALSE(mailbox.read(result));
+}
+
+TEST(microbuf_cpp_latest, concurrent_writer_and_reader)
+{
+    struct counter_pair { uint32_t a; uint32_t b; };
+    microbuf::latest<counter_pair> mailbox {};
+    constexpr uint32_t num_values = 200000;
+
+    std::thread writer([&mailbox]() {
+        for(uint32_t i=1; i<=num_values; ++i) {
+            mailbox.back().a = i;
+            mailbox.back().b = i;
+            mailbox.publish();
+        }
+    });
+
+    uint32_t last = 0;
+    while(last != num_values) {
+        if(mailbox.update()) {
+            const counter_pair& value = mailbox.front();
+            ASSERT_EQ(value.a, value.b); // never torn
+            ASSERT_GT(value.a, last);    // never older than before
+            last = value.a;
+        }
+    }
+    writer.join();
+}
+
+namespace {
+    // Non-blocking UDP socket on 127.0.0.1 with a random port
+    int open_loopback_socket(sockaddr_in& address) {
+        const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        address = sockaddr_in {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t address_len = sizeof(address);
+        if(fd < 0) {
+            return -1;
+        }
+        if(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+           ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_len) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+TEST(microbuf_cpp_latest, epoll_receiver_loopback)
+{
+    sockaddr_in address {};
+    const int rx_fd = open_loopback_socket(address);
+    ASSERT_GE(rx_fd, 0);
+    const int tx_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(tx_fd, 0);
+
+    microbuf::latest<SensorData_struct_t> mailbox {};
+    microbuf::epoll_receiver receiver {};
+    ASSERT_TRUE(receiver.is_open());
+    ASSERT_TRUE(receiver.add(rx_fd, mailbox));
+
+    SensorData_struct_t sensor_data {};
+    for(uint8_t id=1; id<=3; ++id) {
+        sensor_data.robot_id = id;
+        sensor_data.distance[0] = id;
+        const auto bytes = sensor_data.as_bytes();
+        ASSERT_EQ(::sendto(tx_fd, bytes.begin(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&address),
+                           sizeof(address)), static_cast<ssize_t>(bytes.size()));
+    }
+    // corrupted and too short datagrams must not be published
+    auto wrong_bytes = sensor_data.as_bytes();
+    wrong_bytes[5] = 0xf0;
+    ::sendto(tx_fd, wrong_bytes.begin(), wrong_bytes.size(), 0, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address));
+    ::sendto(tx_fd, wrong_bytes.begin(), 10, 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+
+    int num_published = 0;
+    while(receiver.num_published() + receiver.num_rejected() < 5) {
+        const int res = receiver.poll(1000);
+        ASSERT_GE(res, 0);
+        num_published += res;
+    }
+    EXPECT_EQ(num_published, 3);
+    EXPECT_EQ(receiver.num_rejected(), 2U);
+
+    ASSERT_TRUE(mailbox.update());
+    EXPECT_EQ(mailbox.front().robot_id, 3U);
+    EXPECT_EQ(mailbox.front().distance[0], 3.f);
+
+    // stop() wakes up a blocking run()
+    std::thread receive_thread([&receiver]() { receiver.run(); });
+    receiver.stop();
+    receive_thread.join();
+    EXPECT_EQ(receiver.poll(0), 0); // can be used again
+
+    // messages which arrived together with stop() are published and counted
+    sensor_data.robot_id = 4;
+    const auto bytes = sensor_data.as_bytes();
+    ASSERT_EQ(::sendto(tx_fd, bytes.begin(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&address),
+                       sizeof(address)), static_cast<ssize_t>(bytes.size()));
+    receiver.stop();
+    EXPECT_EQ(receiver.poll(1000), -1);
+    EXPECT_EQ(receiver.num_published(), 4U);
+    ASSERT_TRUE(mailbox.update());
+    EXPECT_EQ(mailbox.front().robot_id, 4U);
+
+    ::close(tx_fd);
+    ::close(rx_fd);
+}
+
+TEST(microbuf_cpp_latest, epoll_receiver_continues_after_receive_error)
+{
+    // a connected UDP socket gets ECONNREFUSED after sending to a port without receiver
+    sockaddr_in closed_address {};
+    const int closed_fd = open_loopback_socket(closed_address);
+    ASSERT_GE(closed_fd, 0);
+    ::close(closed_fd);
+    sockaddr_in error_address {};
+    const int error_fd = open_loopback_socket(error_address);
+    ASSERT_GE(error_fd, 0);
+    ASSERT_EQ(::connect(error_fd, reinterpret_cast<sockaddr*>(&closed_address), sizeof(closed_address)), 0);
+
+    sockaddr_in address {};
+    const int rx_fd = open_loopback_socket(address);
+    ASSERT_GE(rx_fd, 0);
+
+    microbuf::latest<SensorData_struct_t> error_mailbox {};
+    microbuf::latest<SensorData_struct_t> mailbox {};
+    microbuf::epoll_receiver receiver {};
+    ASSERT_TRUE(receiver.add(error_fd, error_mailbox));
+    ASSERT_TRUE(receiver.add(rx_fd, mailbox));
+
+    const uint8_t byte = 0;
+    ::send(error_fd, &byte, 1, 0);
+    while(receiver.num_receive_errors() == 0) {
+        ASSERT_GE(receiver.poll(1000), 0);
+    }
+
+    // the other socket is still served
+    SensorData_struct_t sensor_data {};
+    sensor_data.robot_id = 9;
+    const auto bytes = sensor_data.as_bytes();
+    ::sendto(error_fd, bytes.begin(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    while(receiver.num_published() == 0) {
+        ASSERT_GE(receiver.poll(1000), 0);
+    }
+    ASSERT_TRUE(mailbox.update());
+    EXPECT_EQ(mailbox.front().robot_id, 9U);
+    EXPECT_FALSE(error_mailbox.update());
+
+    ::close(error_fd);
+    ::close(rx_fd);
+}
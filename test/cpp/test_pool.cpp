@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+#include "microbuf_pool.h"
+#include "SensorData.h" // SensorData.mmsg must have been converted before trying to compile this!
+#include "TestMessage4.h" // test/messages/TestMessage4.mmsg must have been converted before trying to compile this!
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+    using sensor_pool = microbuf::pool<SensorData_struct_t, 4>;
+    sensor_pool sensor_slots {};
+    constexpr size_t sensor_data_size = SensorData_struct_t::data_size;
+    constexpr size_t test4_min_data_size = TestMessage4_struct_t::min_data_size;
+}
+
+TEST(microbuf_cpp_pool, slots_are_aligned_and_recycled)
+{
+    std::set<sensor_pool::slot*> slots {};
+    for(size_t i=0; i<4; ++i)
+    {
+        sensor_pool::slot* const slot = sensor_slots.acquire();
+        ASSERT_NE(slot, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(slot) % sensor_pool::cache_line_size, 0U);
+        EXPECT_EQ(slot->bytes.size(), sensor_data_size);
+        slots.insert(slot);
+    }
+    EXPECT_EQ(slots.size(), 4U);
+    EXPECT_EQ(sensor_slots.acquire(), nullptr);
+
+    sensor_pool::slot* const released = *slots.begin();
+    sensor_slots.release(released);
+    EXPECT_EQ(sensor_slots.acquire(), released);
+
+    for(sensor_pool::slot* const slot : slots)
+    {
+        sensor_slots.release(slot);
+    }
+    EXPECT_EQ(sensor_slots.statistics().in_use, 0U);
+}
+
+TEST(microbuf_cpp_pool, statistics)
+{
+    microbuf::pool<SensorData_struct_t, 3> pool {};
+    microbuf::pool_statistics stats = pool.statistics();
+    EXPECT_EQ(stats.capacity, 3U);
+    EXPECT_EQ(stats.in_use, 0U);
+    EXPECT_EQ(stats.high_water_mark, 0U);
+
+    auto* const a = pool.acquire();
+    auto* const b = pool.acquire();
+    pool.release(a);
+    stats = pool.statistics();
+    EXPECT_EQ(stats.in_use, 1U);
+    EXPECT_EQ(stats.high_water_mark, 2U);
+
+    pool.reset_high_water_mark();
+    EXPECT_EQ(pool.statistics().high_water_mark, 1U);
+
+    {
+        auto c = pool.acquire_unique();
+        auto d = pool.acquire_unique();
+        auto e = pool.acquire_unique();
+        EXPECT_TRUE(c && d);
+        EXPECT_FALSE(e);
+        EXPECT_EQ(pool.statistics().high_water_mark, 3U);
+        EXPECT_EQ(pool.statistics().failed_acquires, 1U);
+    }
+    pool.release(b);
+    stats = pool.statistics();
+    EXPECT_EQ(stats.in_use, 0U);
+    EXPECT_EQ(stats.high_water_mark, 3U);
+}
+
+TEST(microbuf_cpp_pool, serialize_and_deserialize_slots)
+{
+    microbuf::pool<SensorData_struct_t, 2> pool {};
+    auto tx = pool.acquire_unique();
+    auto rx = pool.acquire_unique();
+
+    tx->msg.distance[9] = 2.5f;
+    tx->msg.robot_id = 42U;
+    EXPECT_EQ(tx->serialize(), sensor_data_size);
+
+    // e.g. receive into the buffer of a slot and decode in place
+    memcpy(rx->bytes.begin(), tx->bytes.begin(), tx->length);
+    rx->length = tx->length;
+    EXPECT_TRUE(rx->deserialize());
+    EXPECT_EQ(rx->msg.distance[9], 2.5f);
+    EXPECT_EQ(rx->msg.robot_id, 42U);
+
+    rx->bytes[10] ^= 0x01U;
+    EXPECT_FALSE(rx->deserialize());
+    rx->length = 0;
+    EXPECT_FALSE(rx->deserialize());
+}
+
+TEST(microbuf_cpp_pool, variable_size_messages)
+{
+    microbuf::pool<TestMessage4_struct_t, 1> pool {};
+    auto slot = pool.acquire_unique();
+    slot->msg.mode = 2U;
+    slot->msg.counter = 99U;
+    EXPECT_EQ(slot->serialize(), test4_min_data_size);
+    slot->msg = TestMessage4_struct_t {};
+    EXPECT_TRUE(slot->deserialize());
+    EXPECT_EQ(slot->msg.mode, 2U);
+    EXPECT_EQ(slot->msg.counter, 99U);
+}
+
+TEST(microbuf_cpp_pool, concurrent_acquire_and_release)
+{
+    constexpr size_t capacity = 8;
+    microbuf::pool<SensorData_struct_t, capacity> pool {};
+    constexpr size_t num_threads = 4;
+    constexpr uint32_t num_rounds = 50000;
+    std::atomic<bool> failed {false};
+
+    std::vector<std::thread> threads {};
+    for(size_t t=0; t<num_threads; ++t)
+    {
+        threads.emplace_back([&pool, &failed, t]() {
+            const uint8_t id = static_cast<uint8_t>(t + 1);
+            for(uint32_t i=0; i<num_rounds; ++i)
+            {
+                auto* const slot = pool.acquire();
+                if(slot == nullptr)
+                {
+                    continue;
+                }
+                // nobody else may own the slot meanwhile
+                slot->msg.robot_id = id;
+                slot->msg.distance[0] = static_cast<float>(i);
+                if(slot->msg.robot_id != id || slot->msg.distance[0] != static_cast<float>(i))
+                {
+                    failed = true;
+                }
+                pool.release(slot);
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_FALSE(failed);
+
+    const microbuf::pool_statistics stats = pool.statistics();
+    EXPECT_EQ(stats.in_use, 0U);
+    EXPECT_LE(stats.high_water_mark, num_threads);
+
+    // all slots are still on the free list exactly once
+    std::set<void*> slots {};
+    for(size_t i=0; i<capacity; ++i)
+    {
+        slots.insert(pool.acquire());
+    }
+    EXPECT_EQ(slots.size(), capacity);
+    EXPECT_EQ(slots.count(nullptr), 0U);
+    EXPECT_EQ(pool.acquire(), nullptr);
+}
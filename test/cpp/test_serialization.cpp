@@ -95,6 +95,69 @@ TEST(microbuf_cpp_serialization, CRC16_AUG_CCITT)
     EXPECT_EQ(microbuf::internal::crc16_aug_ccitt(&bytes[0], 256), 0xE938);
 }
 
+TEST(microbuf_cpp_serialization, CRC32C)
+{
+    // cmp. https://reveng.sourceforge.io/crc-catalogue/17plus.htm#crc.cat.crc-32-iscsi
+    EXPECT_EQ(microbuf::internal::crc32c(nullptr, 0), 0x00000000U);
+    EXPECT_EQ(microbuf::internal::crc32c((const uint8_t*)("123456789"), 9), 0xE3069283U);
+    EXPECT_EQ(microbuf::internal::crc32c((const uint8_t*)("A"), 1), 0xE16DCDEEU);
+
+    // hardware (if available) and software versions agree for all lengths and alignments
+    std::vector<uint8_t> bytes(300);
+    for(size_t i=0; i<bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    for(size_t start=0; start<8; ++start)
+    {
+        for(size_t length=0; length<=bytes.size()-start; length+=13)
+        {
+            EXPECT_EQ(microbuf::internal::crc32c_update(microbuf::internal::crc32c_init, &bytes[start], length),
+                      microbuf::internal::crc32c_update_sw(microbuf::internal::crc32c_init, &bytes[start], length));
+        }
+    }
+}
+
+TEST(microbuf_cpp_serialization, append_crc32c)
+{
+    microbuf::array<uint8_t,15> bytes {};
+    microbuf::insert_bytes<0>(bytes, microbuf::gen_fixarray(1));
+    microbuf::insert_bytes<1>(bytes, microbuf::gen_uint64(1234567890123456789U));
+    microbuf::append_crc32c(bytes);
+    EXPECT_EQ(bytes[10], 0xce);
+    EXPECT_EQ(microbuf::internal::from_big_endian<uint32_t>(&bytes[11]), microbuf::internal::crc32c(&bytes[0], 10));
+    EXPECT_TRUE(microbuf::verify_crc32c(bytes));
+    EXPECT_FALSE(microbuf::verify_crc(bytes.begin(), 13));
+
+    // variable size: CRC after the first 10 bytes
+    microbuf::array<uint8_t,20> bytes2 {};
+    memcpy(bytes2.begin(), bytes.begin(), 10);
+    EXPECT_EQ(microbuf::append_crc32c(bytes2, 10), 15U);
+    EXPECT_TRUE(microbuf::verify_crc32c(bytes2.begin(), 15));
+    bytes2[3] ^= 0x01U;
+    EXPECT_FALSE(microbuf::verify_crc32c(bytes2.begin(), 15));
+}
+
+TEST(microbuf_cpp_serialization, CRC16_combined_from_chunks)
+{
+    // CRC of "1234567890" from the CRCs of "1234" and "567890"
+    const uint8_t* bytes = (const uint8_t*)("1234567890");
+    const uint16_t crc_first = microbuf::internal::crc16_aug_ccitt(bytes, 4);
+    const uint16_t crc_second = microbuf::internal::crc16_update(0, bytes+4, 6);
+    EXPECT_EQ(microbuf::internal::crc16_shift(crc_first, 6) ^ crc_second, 0x57d8);
+
+    std::vector<uint8_t> many_bytes(100000);
+    for(size_t i=0; i<many_bytes.size(); ++i)
+    {
+        many_bytes[i] = static_cast<uint8_t>(i * 7 + i / 256);
+    }
+    microbuf::serial_executor executor {};
+    EXPECT_EQ(microbuf::internal::crc16_aug_ccitt_parallel(&many_bytes[0], many_bytes.size(), executor),
+              microbuf::internal::crc16_aug_ccitt(&many_bytes[0], many_bytes.size()));
+    EXPECT_EQ(microbuf::internal::crc16_aug_ccitt_parallel(&many_bytes[0], 10, executor),
+              microbuf::internal::crc16_aug_ccitt(&many_bytes[0], 10));
+}
+
 TEST(microbuf_cpp_serialization, append_crc)
 {
     microbuf::array<uint8_t,13> bytes {};
@@ -121,4 +184,35 @@ TEST(microbuf_cpp_serialization, gen_multiple)
     EXPECT_EQ(microbuf::gen_multiple_unsafe<3>(source_data3, microbuf::gen_float32),
               (microbuf::array<uint8_t, 15>{0xca, 0x3f, 0x9d, 0x70, 0xa4, 0xca, 0x40, 0x91, 0xeb, 0x85, 0xca, 0x40,
                                             0xfc, 0x7a, 0xe1}));
-}
\ No newline at end of file
+}
+
+TEST(microbuf_cpp_serialization, insert_multiple)
+{
+    const uint16_t source_data[] {1, 2, 3, 100, 200, 300};
+    microbuf::array<uint8_t, 19> bytes {};
+    microbuf::insert_multiple<1>(bytes, source_data, microbuf::gen_uint16);
+    EXPECT_EQ(bytes, (microbuf::array<uint8_t, 19>{0x00, 0xcd, 0x00, 0x01, 0xcd, 0x00, 0x02, 0xcd, 0x00, 0x03, 0xcd,
+                                                   0x00, 0x64, 0xcd, 0x00, 0xc8, 0xcd, 0x01, 0x2c}));
+
+    microbuf::array<uint8_t, 19> bytes2 {};
+    EXPECT_EQ(microbuf::insert_multiple(bytes2, 1, source_data, microbuf::gen_uint16), 19U);
+    EXPECT_EQ(bytes2, bytes);
+}
+
+TEST(microbuf_cpp_serialization, xor_delta)
+{
+    // 1.0 (0x3f800000) stored completely, 1.0 as '0', 2.0 (xor: 0x7f800000) with new window:
+    // '11' + 1 leading zero (5 bits) + 8 meaningful bits (5 bits, minus 1) + 0xff
+    const float values[] {1., 1., 2.};
+    microbuf::array<uint8_t, 15> bytes {};
+    EXPECT_EQ(microbuf::gen_xor_delta(bytes, 1, values), 11U);
+    EXPECT_EQ(bytes, (microbuf::array<uint8_t, 15>{0x00, 0xc4, 0x08, 0x01, 0x3f, 0x80, 0x00, 0x00, 0x61, 0x3f, 0xf8,
+                                                   0x00, 0x00, 0x00, 0x00}));
+
+    // incompressible values are stored raw
+    const float values2[] {1.23, -4.56};
+    microbuf::array<uint8_t, 11> bytes2 {};
+    EXPECT_EQ(microbuf::gen_xor_delta(bytes2, 0, values2), 11U);
+    EXPECT_EQ(bytes2, (microbuf::array<uint8_t, 11>{0xc4, 0x09, 0x00, 0x3f, 0x9d, 0x70, 0xa4, 0xc0, 0x91, 0xeb,
+                                                    0x85}));
+}
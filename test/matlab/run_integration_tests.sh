@@ -13,6 +13,10 @@ echo ""
 echo "- Running MATLAB deserialization for data serialized by C++ (C++ tests must have been run!)"
 BINARY_DATA_IN_FILE=$CPP_FILE octave-cli test_TestMessage1_deserialization.m
 
+echo ""
+echo "- Running MATLAB deserialization of optional fields for data serialized by C++ (C++ tests must have been run!)"
+BINARY_DATA_IN_DIR=../../build octave-cli test_TestMessage4_deserialization.m
+
 echo ""
 echo "- Checking if C++ and MATLAB serialization results are equal"
 diff -q $CPP_FILE $MATLAB_FILE
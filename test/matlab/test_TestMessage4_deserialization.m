@@ -0,0 +1,73 @@
+disp('Executing MATLAB microbuf test: TestMessage4 (optional fields) deserialization');
+
+addpath(fullfile(fileparts(mfilename('fullpath')), "/../../matlab"));
+addpath(fullfile(fileparts(mfilename('fullpath')), "/../../output"));
+
+BINARY_DATA_IN_DIR = getenv('BINARY_DATA_IN_DIR');
+
+disp('Expecting serialized binary data in directory: ');
+disp(BINARY_DATA_IN_DIR);
+
+% combinations of optional fields written by the C++ tests
+names = {'none', 'position', 'lidar_battery_low', 'all'};
+presences = [0 1 6 15];
+all_bytes = cell(1, 4);
+
+for combination=1:4
+    disp(['- presence combination: ' names{combination}]);
+
+    fileID = fopen(fullfile(BINARY_DATA_IN_DIR, ['TestMessage4_' names{combination} '_serialized_by_cpp.bin']));
+    bytes = uint8(fread(fileID));
+    fclose(fileID);
+    all_bytes{combination} = bytes;
+
+    [err, mode, position, lidar, battery_low, samples, counter, has_position, has_lidar, has_battery_low, has_samples] = deserialize_TestMessage4(bytes, length(bytes));
+    presence = presences(combination);
+    if err || mode ~= combination-1 || counter ~= 123456+combination-1 ||...
+        has_position ~= bitget(presence, 1) || has_lidar ~= bitget(presence, 2) ||...
+        has_battery_low ~= bitget(presence, 3) || has_samples ~= bitget(presence, 4)
+        error('Error deserializing message');
+    end
+
+    % absent fields keep their default values
+    if ~all(position == has_position*[1.5 -2.5 4]) || ~all(lidar == has_lidar*(0:359)*0.5) ||...
+        battery_low ~= has_battery_low || ~all(samples == has_samples*floor((0:15)/8))
+        error('Error deserializing optional fields');
+    end
+end
+
+disp('- changed messages with matching CRC...');
+
+% a changed mode is accepted once the CRC matches again
+bytes = all_bytes{1};
+bytes(7) = 5;
+bytes(end-2:end) = microbuf.gen_uint16(microbuf.crc16_aug_ccitt(bytes, length(bytes)-3));
+[err, mode] = deserialize_TestMessage4(bytes, length(bytes));
+if err || mode ~= 5
+    error('Error deserializing changed message');
+end
+
+% unknown optional field
+bytes = all_bytes{1};
+bytes(5) = hex2dec('10');
+bytes(end-2:end) = microbuf.gen_uint16(microbuf.crc16_aug_ccitt(bytes, length(bytes)-3));
+if ~deserialize_TestMessage4(bytes, length(bytes))
+    error('Unknown presence bit not detected');
+end
+
+% presence does not match the number of elements in the array header
+bytes = all_bytes{1};
+bytes(5) = 1;
+bytes(end-2:end) = microbuf.gen_uint16(microbuf.crc16_aug_ccitt(bytes, length(bytes)-3));
+if ~deserialize_TestMessage4(bytes, length(bytes))
+    error('Presence/count mismatch not detected');
+end
+
+bytes = all_bytes{2};
+bytes(5) = 0;
+bytes(end-2:end) = microbuf.gen_uint16(microbuf.crc16_aug_ccitt(bytes, length(bytes)-3));
+if ~deserialize_TestMessage4(bytes, length(bytes))
+    error('Presence/count mismatch not detected');
+end
+
+disp('All tests passed!');
@@ -193,6 +193,25 @@ if microbuf.check_crc(uint8([hex2dec('cd') hex2dec('1d') hex2dec('0f')]), 3, 1)
     error('CRC error');
 end
 
+disp('- CRC-32C tests...');
+if microbuf.crc32c([], 0) ~= 0
+    error('CRC-32C error');
+end
+
+if microbuf.crc32c(uint8('123456789'), 9) ~= hex2dec('e3069283')
+    error('CRC-32C error');
+end
+
+bytes = [uint8('123456789') microbuf.gen_uint32(microbuf.crc32c(uint8('123456789'), 9))];
+if microbuf.check_crc32c(bytes, length(bytes), 10)
+    error('CRC-32C error');
+end
+
+bytes(3) = bitxor(bytes(3), 1);
+if ~microbuf.check_crc32c(bytes, length(bytes), 10)
+    error('CRC-32C error');
+end
+
 disp('- float tests...');
 
 bytes = uint8([hex2dec('ca') 0 0 0 0]);
@@ -219,4 +238,23 @@ if idx ~= 10 || err || value ~= -2048.25 || ~isa(value, 'double')
     error('float err');
 end
 
+disp('- xor_delta tests...');
+
+bytes = uint8([hex2dec('c4') 8 1 hex2dec('3f') hex2dec('80') 0 0 hex2dec('61') hex2dec('3f') hex2dec('f8')]);
+[idx, err, values] = microbuf.parse_xor_delta_float32(bytes, length(bytes), 3, 1);
+if idx ~= 11 || err || ~all(values == [1 1 2]) || ~isa(values, 'single')
+    error('xor_delta err');
+end
+
+[idx, err, values] = microbuf.parse_xor_delta_float32(bytes, length(bytes)-1, 3, 1);
+if ~err
+    error('xor_delta err');
+end
+
+bytes = uint8([hex2dec('c4') 9 0 hex2dec('3f') hex2dec('80') 0 0 hex2dec('c0') 0 0 0]);
+[idx, err, values] = microbuf.parse_xor_delta_float32(bytes, length(bytes), 2, 1);
+if idx ~= 12 || err || ~all(values == [1 -2])
+    error('xor_delta err');
+end
+
 disp('All tests passed!');
@@ -111,4 +111,11 @@ if any(microbuf.gen_float64(-2048.25) ~= uint8([hex2dec('cb') hex2dec('C0') hex2
 end
 
 
+disp('- xor_delta tests...');
+
+if any(microbuf.gen_xor_delta_float32(single([1 -2])) ~= uint8([hex2dec('c4') 9 0 hex2dec('3f') hex2dec('80') 0 0 hex2dec('c0') 0 0 0]))
+    error('xor_delta err');
+end
+
+
 disp('All tests passed!');
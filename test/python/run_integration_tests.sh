@@ -0,0 +1,8 @@
+#!/bin/bash
+cd "${0%/*}"
+
+CPP_FILE=../../build/TestMessage1_serialized_by_cpp.bin
+
+echo ""
+echo "- Running Python (NumPy) decoding for data serialized by C++ (C++ tests must have been run!)"
+BINARY_DATA_IN_FILE=$CPP_FILE python3 test_TestMessage1_numpy.py
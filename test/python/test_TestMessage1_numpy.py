@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+# Decode many copies of a TestMessage1 serialized by C++ at once with the generated NumPy module
+import os
+import sys
+
+import numpy as np
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../python"))
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../output"))
+import microbuf_numpy
+import TestMessage1
+
+print("Executing Python microbuf test: TestMessage1 NumPy decoding")
+
+binary_data_in_file = os.environ["BINARY_DATA_IN_FILE"]
+print("Expecting serialized binary data in file: {}".format(binary_data_in_file))
+with open(binary_data_in_file, "rb") as in_file:
+    message = in_file.read()
+assert len(message) == TestMessage1.data_size
+
+# recording with 1000 messages: a wrong prefix in message 10, a changed value in message 20 (only the CRC notices)
+recording = bytearray(message * 1000)
+recording[10 * TestMessage1.data_size + 4] = 0xcd
+recording[20 * TestMessage1.data_size + 101] ^= 0x01
+
+columns, valid = TestMessage1.decode(bytes(recording))
+assert valid.shape == (1000,)
+assert np.flatnonzero(~valid).tolist() == [10]
+assert np.all(columns["bool_val"])
+for name in ("uint8_val", "uint16_val", "uint32_val", "uint64_val"):
+    assert np.all(columns[name] == 123), name
+assert columns["uint64_val"].dtype == np.dtype("=u8")
+assert columns["float32_arr_val"].shape == (1000, 10)
+assert np.all(columns["float32_arr_val"][0] == np.arange(10))
+assert np.all(columns["float64_arr_val"][999] == np.arange(10))
+
+columns, valid = TestMessage1.decode(bytes(recording), check_crc=True)
+assert np.flatnonzero(~valid).tolist() == [10, 20]
+
+# trailing incomplete message is ignored
+columns, valid = TestMessage1.decode(bytes(recording) + message[:50])
+assert valid.shape == (1000,)
+
+# CRC check values, cmp. test/cpp/test_serialization.cpp
+check_bytes = np.frombuffer(b"123456789", dtype=np.uint8).reshape(1, -1)
+assert microbuf_numpy.crc16_aug_ccitt(check_bytes)[0] == 0xe5cc
+assert microbuf_numpy.crc32c(check_bytes)[0] == 0xe3069283
+
+print("All tests passed!")